@@ -1,18 +1,32 @@
 #pragma once
 
 #include <zmq.hpp>
+#include <array>
 
 #include "Queue.hpp"
+#include "WaitStrategy.hpp"
 #include "HashMap.hpp"
+#include "SymbolTable.hpp"
 #include "MemoryPool.hpp"
 #include "AsyncLogger.hpp"
 #include "Messages.hpp"
 #include "Utils.hpp"
 
-// using MyHashMap = HashMap<FixedSizedChainingHashMap<std::string, std::pair<double, double>>>;
+namespace Const {
+#ifndef AGG_SYMBOL_BUCKETS
+    constexpr size_t aggSymbolBuckets = 1024;   // Initial index size of the per-interval symbol table
+#else
+    constexpr size_t aggSymbolBuckets = AGG_SYMBOL_BUCKETS;
+#endif
+}
+
+// Keyed by interned symbol id and cleared every interval, which DenseHashMap does in O(1)
+// while iterating only the live symbols
+using AggHashMap = HashMap<DenseHashMap<SymbolId, std::pair<double, double>>>;
 
 /**************************************************************************/
-template <typename TradeMsg, MyQ RecvMsgQueue, MyPool Pool, bool DESTROY_MESSAGES = true>
+template <typename TradeMsg, MyQ RecvMsgQueue, MyPool Pool, bool DESTROY_MESSAGES = true, 
+          typename Wait = YieldWait>
 class AggregatedTradeMQSender {
 public:
     using TradeMsgPtr = TradeMsg*;
@@ -39,23 +53,29 @@ public:
     }
     void run() {
         logger_.log("AggregatedTradeMQSender run\n");
+        std::array<TradeMsgPtr, Const::queueBulkSize> msgs;
         try {
             while (runFlag_.load(std::memory_order_relaxed)) {
-                TradeMsgPtr msg = recvQueue_.dequeue();
-                if (!msg) {
-                    std::this_thread::yield();
+                const size_t count = recvQueue_.dequeue_bulk(msgs);
+                if (count == 0) {
+                    wait_.idle(recvQueue_);
                     continue;
                 }
-                const uint64_t msgTime = msg->timestamp / 1000;
-                if (msgTime != currentTime_) {
-                    SendMQ();
-                    currentTime_ = msgTime;
+                wait_.reset();
+                for (size_t i = 0; i < count; ++i) {
+                    TradeMsgPtr msg = msgs[i];
+                    trackOwner(msgPool_, msg, "AggregatedTradeMQSender");
+                    const uint64_t msgTime = msg->timestamp / 1000;
+                    if (msgTime != currentTime_) {
+                        SendMQ();
+                        currentTime_ = msgTime;
+                    }
+                    AggregateTrade(msg);
                 }
-                AggregateTrade(msg);
                 if constexpr (DESTROY_MESSAGES) {
-                    msgPool_.deallocate(msg);
-                } 
-                ++recvedMsgs_;
+                    msgPool_.deallocate_bulk(std::span<const TradeMsgPtr>(msgs.data(), count));
+                }
+                recvedMsgs_ += count;
             }
         } 
         catch (const std::exception& e) {
@@ -67,8 +87,9 @@ private:
         char buffer[128];
         for (auto& [sym, val] : aggMap_) {
             double vwap = val.first / val.second;
-            int len = std::snprintf(buffer, sizeof(buffer), "%s,%llu,%.6f",
-                                sym.c_str(), currentTime_, vwap);
+            const std::string_view name = symbols_.name(sym);
+            int len = std::snprintf(buffer, sizeof(buffer), "%.*s,%llu,%.6f",
+                                static_cast<int>(name.size()), name.data(), currentTime_, vwap);
 
             if (len > 0 && len < static_cast<int>(sizeof(buffer))) {
                 zmq::message_t message(buffer, len);
@@ -80,8 +101,7 @@ private:
         aggMap_.clear();
     }
     void AggregateTrade(TradeMsgPtr msg) {
-        std::string symbol(msg->symbol, strnlen(msg->symbol, 8));
-        auto& val = aggMap_[symbol];
+        auto& val = aggMap_[symbols_.intern(msg->symbol)];
         val.first += msg->price * msg->quantity;
         val.second += msg->quantity;
     }
@@ -90,8 +110,10 @@ private:
     AsyncLogger& logger_;
     std::unique_ptr<zmq::context_t> context_;
     std::unique_ptr<zmq::socket_t> publisher_;
+    Wait wait_;
     alignas(64) std::atomic<bool> runFlag_{true};
     uint64_t currentTime_ {};
-    std::unordered_map<std::string, std::pair<double, double>> aggMap_; // symbol -> (sum(price*qty), sum(qty))
+    SymbolTable symbols_;
+    AggHashMap aggMap_{ Const::aggSymbolBuckets }; // symbol id -> (sum(price*qty), sum(qty))
     size_t recvedMsgs_ {}, sentMsgs_ {};
 };
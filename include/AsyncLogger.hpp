@@ -6,8 +6,7 @@
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
-#include "Queue.hpp"
-#include "MemoryPool.hpp"
+#include "ByteRingBuffer.hpp"
 
 namespace Const {
 #ifdef LOG_BUFFER_SIZE
@@ -15,19 +14,21 @@ namespace Const {
 #else
     constexpr size_t LogBufferSize = 512;
 #endif
+#ifdef LOG_RING_BYTES
+    constexpr size_t LogRingBytes = LOG_RING_BYTES;
+#else
+    constexpr size_t LogRingBytes = 1 << 24; // 16MB of in-flight log records
+#endif
 };
 
-struct alignas(64) LogMsg {
-    char buffer[Const::LogBufferSize];
-    size_t len = 0;
-};
+constexpr uint16_t LogRecordType = 1;
 
 class AsyncLogger {
 public:
-    using LogMsgPtr = LogMsg*;
     AsyncLogger(std::ostream& outStream) 
             : outStream_(outStream)
-            , runFlag_(true) {
+            , runFlag_(true)
+            , ring_(Const::LogRingBytes) {
         
         loggerThread_ = std::thread(&AsyncLogger::LoggerThread, this);
     }
@@ -40,32 +41,34 @@ public:
 
     template<typename... Args>
     void log(const char* fmt, Args&&... args) {
-        LogMsgPtr msg = pool_.allocate();
-        if (!msg) {
-            throw std::runtime_error("Logger Pool Exhausted");
+        auto record = ring_.reserve(Const::LogBufferSize);
+        if (!record.data) {
+            throw std::runtime_error("Logger Ring Buffer Exhausted");
         }
 
-        int len = std::snprintf(msg->buffer, sizeof(msg->buffer), fmt, std::forward<Args>(args)...);
+        // Format straight into the ring, commit() hands back the unused part of the reservation
+        int len = std::snprintf(record.data, Const::LogBufferSize, fmt, std::forward<Args>(args)...);
         if (len < 0) {
-            pool_.deallocate(msg);
+            ring_.commit(record, PaddingRecordType, 0);
             throw std::runtime_error("Encoding error during formatting");
         }
-        msg->len = (len < (int)sizeof(msg->buffer)) ? len : (int)sizeof(msg->buffer) - 1;
+        len = (len < (int)Const::LogBufferSize) ? len : (int)Const::LogBufferSize - 1;
 
-        queue_.enqueue(msg);
+        ring_.commit(record, LogRecordType, len);
     }
 
 private:
     void LoggerThread() {
         using namespace std::chrono;
         uint32_t spin = 0;
+        auto write = [this](uint16_t, const char* buffer, size_t len) {
+            auto now = high_resolution_clock::now();
+            outStream_ << "[" << duration_cast<nanoseconds>(now.time_since_epoch()).count() << "] | ";
+            outStream_.write(buffer, len);
+        };
         while (runFlag_.load()) {
-            if (LogMsgPtr msg = queue_.dequeue()) {
-                auto now = high_resolution_clock::now();
-                outStream_ << "[" << duration_cast<nanoseconds>(now.time_since_epoch()).count() << "] | ";
-                outStream_.write(msg->buffer, msg->len);
+            if (ring_.consume(write) > 0) {
                 outStream_.flush();
-                pool_.deallocate(msg);
                 spin = 0;
             } 
             else if (++spin < 1000) {
@@ -75,12 +78,12 @@ private:
                 std::this_thread::sleep_for(microseconds(50)); // Idle fallback
                 spin = 0;
             }
-        }       
+        }
+        while (ring_.consume(write) > 0) { }                   // Drain what was logged before stop
     }
 
     std::ostream& outStream_;
     std::thread loggerThread_;
     alignas(64) std::atomic<bool> runFlag_;
-    Queue<CustomMPMCLockFreeQueue<LogMsgPtr>> queue_;
-    MemoryPool<LockFreeThreadSafePool<LogMsg, true>> pool_;
+    MPSCByteRingBuffer ring_;
 };
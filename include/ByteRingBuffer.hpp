@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace Const {
+#ifndef RING_BUFFER_BYTES
+    constexpr size_t ringBufferBytes = 1 << 24; // 16MB - Default byte ring capacity
+#else
+    constexpr size_t ringBufferBytes = RING_BUFFER_BYTES; // Use user-defined capacity
+#endif
+};
+
+// Every record starts with this header and is padded to a multiple of 8 bytes
+struct RecordHeader {
+    uint32_t size;      // bytes taken by the record including the header, 0 until committed
+    uint16_t type;      // application defined, PaddingRecordType is reserved
+    uint16_t length;    // payload bytes following the header
+};
+static_assert(sizeof(RecordHeader) == 8);
+
+constexpr uint16_t PaddingRecordType = 0xFFFF;
+
+/**************************************************************************
+Contiguous ring of variable-length records stored by value. Producers reserve
+space, write the payload in place and commit it; the single consumer walks the
+records sequentially and releases them in one head_ store per consume() call.
+MultiProducer = false gives an SPSC ring, true gives an MPSC ring where producers
+claim space with a CAS and publish each record through its header.
+Check TestByteRingBuffer.cpp for usage examples.
+**************************************************************************/
+template <bool MultiProducer = false>
+class ByteRingBuffer {
+public:
+    struct Reservation {
+        char* data = nullptr;   // payload, nullptr when the ring is full
+        uint64_t pos = 0;       // ring position of the record header
+        uint32_t size = 0;      // bytes reserved for the record including the header
+    };
+
+    explicit ByteRingBuffer(size_t capacity = Const::ringBufferBytes)
+            : buffer_(capacity / sizeof(uint64_t))
+            , capacity_(capacity)
+            , mask_(capacity - 1) {
+        if (capacity_ < 64 || (capacity_ & mask_) != 0) {
+            throw std::invalid_argument("Capacity must be a power of two and at least 64 bytes.");
+        }
+        std::cout << "Using " << (MultiProducer ? "MPSC" : "SPSC") << " ByteRingBuffer "
+                  << capacity_ << " bytes...\n";
+    }
+    ByteRingBuffer(ByteRingBuffer const&) = delete;
+    ByteRingBuffer& operator=(ByteRingBuffer const&) = delete;
+
+    // Reserves room for up to maxLength payload bytes
+    inline Reservation reserve(size_t maxLength) {
+        const size_t need = recordSize(maxLength);
+        if (maxLength > UINT16_MAX || need > capacity_ / 2) [[unlikely]] {
+            throw std::invalid_argument("Record does not fit in the ByteRingBuffer");
+        }
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        size_t pad = 0;
+        while (true) {
+            const size_t offset = tail & mask_;
+            pad = (offset + need > capacity_) ? capacity_ - offset : 0;
+            if constexpr (!MultiProducer) {
+                if (tail + pad + need - headCache_ > capacity_) {
+                    headCache_ = head_.load(std::memory_order_acquire);
+                    if (tail + pad + need - headCache_ > capacity_) {
+                        return {};
+                    }
+                }
+                break;
+            }
+            else {
+                if (tail + pad + need - head_.load(std::memory_order_acquire) > capacity_) {
+                    return {};
+                }
+                // acquire pairs with the release of a trimming commit() that zeroed this space
+                if (tail_.compare_exchange_weak(tail, tail + pad + need,
+                        std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+        }
+        if (pad > 0) {  // record would straddle the end, fill the rest of the ring and start over
+            RecordHeader* padding = header(tail);
+            padding->type = PaddingRecordType;
+            padding->length = 0;
+            publishSize(padding, static_cast<uint32_t>(pad));
+        }
+        const uint64_t pos = tail + pad;
+        return { reinterpret_cast<char*>(header(pos) + 1), pos, static_cast<uint32_t>(need) };
+    }
+
+    // Publishes a reserved record carrying length (<= reserved) payload bytes
+    inline void commit(const Reservation& res, uint16_t type, size_t length) {
+        RecordHeader* hdr = header(res.pos);
+        hdr->type = type;
+        hdr->length = static_cast<uint16_t>(length);
+        uint32_t size = static_cast<uint32_t>(recordSize(length));
+        if constexpr (!MultiProducer) {
+            hdr->size = size;
+            tail_.store(res.pos + size, std::memory_order_release);
+        }
+        else {
+            if (size < res.size) {
+                // Hand back the unused tail if no other producer has claimed past us. The bytes
+                // may have been dirtied (e.g. a NUL terminator) and must read as zero again.
+                std::memset(reinterpret_cast<char*>(hdr) + size, 0, res.size - size);
+                uint64_t expected = res.pos + res.size;
+                if (!tail_.compare_exchange_strong(expected, res.pos + size,
+                        std::memory_order_release, std::memory_order_relaxed)) {
+                    size = res.size;
+                }
+            }
+            publishSize(hdr, size);
+        }
+    }
+
+    // Calls fn(type, payload, length) for up to maxRecords committed records, returns the count
+    template <typename Fn>
+    inline size_t consume(Fn&& fn, size_t maxRecords = SIZE_MAX) {
+        const uint64_t start = head_.load(std::memory_order_relaxed);
+        uint64_t head = start;
+        size_t count = 0;
+        while (count < maxRecords) {
+            RecordHeader* hdr = header(head);
+            uint32_t size = 0;
+            if constexpr (!MultiProducer) {
+                if (head == tailCache_) {
+                    tailCache_ = tail_.load(std::memory_order_acquire);
+                    if (head == tailCache_) break;
+                }
+                size = hdr->size;
+            }
+            else {
+                size = std::atomic_ref<uint32_t>(hdr->size).load(std::memory_order_acquire);
+                if (size == 0) break;
+            }
+            if (hdr->type != PaddingRecordType) {
+                fn(hdr->type, reinterpret_cast<const char*>(hdr + 1), static_cast<size_t>(hdr->length));
+                ++count;
+            }
+            if constexpr (MultiProducer) {  // producers rely on unclaimed space reading as zero
+                std::atomic_ref<uint32_t>(hdr->size).store(0, std::memory_order_relaxed);
+                std::memset(reinterpret_cast<char*>(hdr) + sizeof(uint32_t), 0, size - sizeof(uint32_t));
+            }
+            head += size;
+        }
+        if (head != start) {
+            head_.store(head, std::memory_order_release);
+        }
+        return count;
+    }
+
+    inline bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr size_t recordSize(size_t length) {
+        return (sizeof(RecordHeader) + length + 7) & ~static_cast<size_t>(7);
+    }
+    inline RecordHeader* header(uint64_t pos) {
+        return reinterpret_cast<RecordHeader*>(reinterpret_cast<char*>(buffer_.data()) + (pos & mask_));
+    }
+    static inline void publishSize(RecordHeader* hdr, uint32_t size) {
+        if constexpr (MultiProducer) {
+            std::atomic_ref<uint32_t>(hdr->size).store(size, std::memory_order_release);
+        }
+        else {
+            hdr->size = size;
+        }
+    }
+
+    std::vector<uint64_t> buffer_;      // uint64_t keeps records 8-byte aligned
+    size_t capacity_{ 0 };
+    size_t mask_{ 0 };
+    alignas(64) std::atomic<uint64_t> tail_{ 0 };   // written by producers
+    uint64_t headCache_{ 0 };                       // producer's view of head_ (SPSC only)
+    alignas(64) std::atomic<uint64_t> head_{ 0 };   // written by the consumer
+    uint64_t tailCache_{ 0 };                       // consumer's view of tail_ (SPSC only)
+};
+
+using SPSCByteRingBuffer = ByteRingBuffer<false>;
+using MPSCByteRingBuffer = ByteRingBuffer<true>;
+
+/**************************************************************************/
@@ -1,11 +1,14 @@
 #include <pqxx/pqxx>
 #include <thread>
 #include <chrono>
+#include <span>
 
 #include "Queue.hpp"
+#include "WaitStrategy.hpp"
 #include "MemoryPool.hpp"
 #include "AsyncLogger.hpp"
 #include "Messages.hpp"
+#include "SymbolTable.hpp"
 
 namespace Const {
 #ifndef DB_BATCH_SIZE
@@ -16,7 +19,8 @@ namespace Const {
 };
 
 /**************************************************************************/
-template <typename TradeMsg, MyQ RecvMsgQueue, MyPool Pool, bool DESTROY_MESSAGES = true>
+template <typename TradeMsg, MyQ RecvMsgQueue, MyPool Pool, bool DESTROY_MESSAGES = true, 
+          typename Wait = YieldWait>
 class DBManager {
 public:
     using TradeMsgPtr = TradeMsg*;
@@ -60,9 +64,11 @@ private:
             while (runFlag_.load(std::memory_order_relaxed)) {
                 TradeMsgPtr msg = recvQueue_.dequeue();
                 if (!msg) {
-                    std::this_thread::yield();
+                    wait_.idle(recvQueue_);
                     continue;
                 }
+                wait_.reset();
+                trackOwner(msgPool_, msg, "DBManager");
                 commitSingle(msg);
                 if constexpr (DESTROY_MESSAGES) {
                     msgPool_.deallocate(msg);
@@ -89,7 +95,7 @@ private:
                     msg->quantity,
                     msg->buyer_is_maker,
                     msg->best_match,
-                    std::string(msg->symbol)
+                    symbolOf(msg)
                 }
             );
 
@@ -102,53 +108,51 @@ private:
 
     void runBatch() {
         logger_.log("DBManager run BATCH\n");
-        std::vector<TradeMsgPtr> batch;
-        batch.reserve(Const::commitBatchSize);
+        std::vector<TradeMsgPtr> batch(Const::commitBatchSize);
+        size_t batchCount = 0;
 
         try {
             while (runFlag_.load(std::memory_order_relaxed)) {
-                TradeMsgPtr msg = recvQueue_.dequeue();
-                if (!msg) {
-                    if (!batch.empty()) {
-                        commitBatch(batch);
-                        if constexpr (DESTROY_MESSAGES) {
-                            for (auto m : batch) 
-                                msgPool_.deallocate(m);
-                        }
-                        batch.clear();
+                const size_t count = recvQueue_.dequeue_bulk(
+                    std::span<TradeMsgPtr>(batch).subspan(batchCount));
+                if (count == 0) {
+                    if (batchCount > 0) {
+                        flushBatch(batch, batchCount);
                     }
                     else {
-                        std::this_thread::yield();
+                        wait_.idle(recvQueue_);
                     }
                     continue;
                 }
+                wait_.reset();
+                for (size_t i = batchCount; i < batchCount + count; ++i) {
+                    trackOwner(msgPool_, batch[i], "DBManager");
+                }
+                batchCount += count;
 
-                batch.emplace_back(msg);
-
-                if (batch.size() >= Const::commitBatchSize) {
-                    commitBatch(batch);
-                    if constexpr (DESTROY_MESSAGES) {
-                        for (auto m : batch) 
-                            msgPool_.deallocate(m);
-                    }
-                    batch.clear();
+                if (batchCount >= Const::commitBatchSize) {
+                    flushBatch(batch, batchCount);
                 }
             }
 
-            if (!batch.empty()) {
+            if (batchCount > 0) {
                 logger_.log("DBManager flush remaining BATCH\n");
-                commitBatch(batch);
-                if constexpr (DESTROY_MESSAGES) {
-                    for (auto m : batch) 
-                        msgPool_.deallocate(m);
-                }
+                flushBatch(batch, batchCount);
             }
         } 
         catch (const std::exception& e) {
             std::cerr << "DBManager run() error: " << e.what() << std::endl;
         }
     }
-    void commitBatch(const std::vector<TradeMsgPtr>& batch) {
+    void flushBatch(std::vector<TradeMsgPtr>& batch, size_t& batchCount) {
+        const std::span<const TradeMsgPtr> msgs(batch.data(), batchCount);
+        commitBatch(msgs);
+        if constexpr (DESTROY_MESSAGES) {
+            msgPool_.deallocate_bulk(msgs);
+        }
+        batchCount = 0;
+    }
+    void commitBatch(std::span<const TradeMsgPtr> batch) {
         try {
             pqxx::work txn(*conn_);
             // std::time_t db_time = std::time(nullptr);
@@ -165,7 +169,7 @@ private:
                         msg->quantity,
                         msg->buyer_is_maker,
                         msg->best_match,
-                        std::string(msg->symbol)
+                        symbolOf(msg)
                     }
                 );
             }
@@ -178,53 +182,51 @@ private:
 
     void runCopy() {
         logger_.log("DBManager run COPY\n");
-        std::vector<TradeMsgPtr> batch;
-        batch.reserve(Const::commitBatchSize);
+        std::vector<TradeMsgPtr> batch(Const::commitBatchSize);
+        size_t batchCount = 0;
 
         try {
             while (runFlag_.load(std::memory_order_relaxed)) {
-                TradeMsgPtr msg = recvQueue_.dequeue();
-                if (!msg) {
-                    if (!batch.empty()) {
-                        commitCopy(batch);
-                        if constexpr (DESTROY_MESSAGES) {
-                            for (auto m : batch) 
-                                msgPool_.deallocate(m);
-                        }
-                        batch.clear();
+                const size_t count = recvQueue_.dequeue_bulk(
+                    std::span<TradeMsgPtr>(batch).subspan(batchCount));
+                if (count == 0) {
+                    if (batchCount > 0) {
+                        flushCopy(batch, batchCount);
                     }
                     else {
-                        std::this_thread::yield();
+                        wait_.idle(recvQueue_);
                     }
                     continue;
                 }
+                wait_.reset();
+                for (size_t i = batchCount; i < batchCount + count; ++i) {
+                    trackOwner(msgPool_, batch[i], "DBManager");
+                }
+                batchCount += count;
 
-                batch.emplace_back(msg);
-
-                if (batch.size() >= Const::commitBatchSize) {
-                    commitCopy(batch);
-                    if constexpr (DESTROY_MESSAGES) {
-                        for (auto m : batch) 
-                            msgPool_.deallocate(m);
-                    }
-                    batch.clear();
+                if (batchCount >= Const::commitBatchSize) {
+                    flushCopy(batch, batchCount);
                 }
             }
 
-            if (!batch.empty()) {
+            if (batchCount > 0) {
                 logger_.log("DBManager flush remaining BATCH\n");
-                commitCopy(batch);
-                if constexpr (DESTROY_MESSAGES) {
-                    for (auto m : batch) 
-                        msgPool_.deallocate(m);
-                }
+                flushCopy(batch, batchCount);
             }
         } 
         catch (const std::exception& e) {
             std::cerr << "DBManager run() error: " << e.what() << std::endl;
         }
     }
-    void commitCopy(const std::vector<TradeMsgPtr>& batch) {
+    void flushCopy(std::vector<TradeMsgPtr>& batch, size_t& batchCount) {
+        const std::span<const TradeMsgPtr> msgs(batch.data(), batchCount);
+        commitCopy(msgs);
+        if constexpr (DESTROY_MESSAGES) {
+            msgPool_.deallocate_bulk(msgs);
+        }
+        batchCount = 0;
+    }
+    void commitCopy(std::span<const TradeMsgPtr> batch) {
         try {
             pqxx::work txn(*conn_);
             std::time_t db_time = std::time(nullptr);
@@ -246,7 +248,7 @@ private:
                     msg->quantity,
                     msg->buyer_is_maker,
                     msg->best_match,
-                    std::string(msg->symbol)
+                    symbolOf(msg)
                 ));
             }
 
@@ -256,10 +258,16 @@ private:
             std::cerr << "DBManager commit() error: " << e.what() << std::endl;
         }
     }
+    // The symbol field isn't null-terminated when a symbol uses all 8 bytes, so rows take the interned name
+    std::string_view symbolOf(const TradeMsgPtr msg) {
+        return symbols_.name(symbols_.intern(msg->symbol));
+    }
     const std::string& connStr_;
     RecvMsgQueue& recvQueue_;
     Pool& msgPool_;
     AsyncLogger& logger_;
+    Wait wait_;
     alignas(64) std::atomic<bool> runFlag_{true};
     std::unique_ptr<pqxx::connection> conn_;
+    SymbolTable symbols_;
 };
\ No newline at end of file
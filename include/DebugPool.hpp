@@ -0,0 +1,179 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "MemoryPool.hpp"
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#define POOL_POISON(addr, size) ASAN_POISON_MEMORY_REGION(addr, size)
+#define POOL_UNPOISON(addr, size) ASAN_UNPOISON_MEMORY_REGION(addr, size)
+#else
+#define POOL_POISON(addr, size) ((void)(addr), (void)(size))
+#define POOL_UNPOISON(addr, size) ((void)(addr), (void)(size))
+#endif
+
+// Pools that touch a free slot themselves: BoostPool links free slots through their first
+// word and constructs the whole Msg in allocate(), before DebugPool could unpoison it
+template <typename P>
+constexpr bool poolWritesFreeSlots = false;
+template <class Msg, bool ThreadSafe>
+constexpr bool poolWritesFreeSlots<BoostPool<Msg, ThreadSafe>> = true;
+
+/**************************************************************************
+Checking wrapper around any pool, selected with POOL_DEBUG. It keeps a side table
+with a state byte, the stage that last held the message (see trackOwner() in
+MemoryPool.hpp) and the allocation epoch for every slot the pool has handed out.
+A double free or a pointer the pool never handed out throws at the offending
+call, and dumpLive() lists slots that were never returned, grouped by stage.
+Under ASAN freed messages are poisoned until they are handed out again. The
+poison goes on under the same lock as the bookkeeping and before the slot is
+back in the pool, so it can never land on a message another thread has just
+been handed. Pools that write into free slots (poolWritesFreeSlots) are
+tracked but not poisoned. Derives from the pool so its own accessors stay available.
+**************************************************************************/
+template <MyPool P>
+class DebugPool : public P {
+public:
+    using MsgPtr = typename P::MsgPtr;
+    using Msg = std::remove_pointer_t<MsgPtr>;
+
+    template <typename... Args>
+    explicit DebugPool(Args&&... args) : P(std::forward<Args>(args)...) {
+        std::cout << "DebugPool tracking allocations of " << typeid(Msg).name() << "\n";
+    }
+    ~DebugPool() {
+        for (const auto& [msg, info] : slots_) {   // the pool's memory may be mapped again later
+            POOL_UNPOISON(msg, sizeof(Msg));
+        }
+    }
+    DebugPool(DebugPool const&) = delete;
+    DebugPool& operator=(DebugPool const&) = delete;
+
+    MsgPtr allocate() {
+        MsgPtr msg = P::allocate();
+        if (msg != nullptr) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            onAllocate(msg);
+        }
+        return msg;
+    }
+    void deallocate(MsgPtr msg) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            onDeallocate(msg);
+        }
+        P::deallocate(msg);
+    }
+    size_t allocate_bulk(size_t n, MsgPtr* out) {
+        const size_t count = P::allocate_bulk(n, out);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < count; ++i) {
+            onAllocate(out[i]);
+        }
+        return count;
+    }
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (MsgPtr msg : msgs) {
+                onDeallocate(msg);
+            }
+        }
+        P::deallocate_bulk(msgs);
+    }
+
+    // Records that stage now holds msg, called through trackOwner(pool, msg, stage)
+    void trackOwner(MsgPtr msg, const char* stage) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SlotInfo& info = checkedSlot(msg, "trackOwner");
+        if (info.state != SlotState::Live) {
+            throw std::runtime_error(describe("DebugPool: " + std::string(stage) + " holds a freed message", msg, info));
+        }
+        info.stage = stage;
+    }
+
+    size_t liveCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return live_;
+    }
+    // Slots allocated and not yet freed, grouped by the stage that last held them
+    void dumpLive(std::ostream& os = std::cerr) const {
+        struct StageSummary {
+            size_t count = 0;
+            uint64_t oldestEpoch = UINT64_MAX;
+        };
+        std::map<std::string, StageSummary> byStage;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [msg, info] : slots_) {
+            if (info.state == SlotState::Live) {
+                StageSummary& summary = byStage[info.stage];
+                ++summary.count;
+                summary.oldestEpoch = std::min(summary.oldestEpoch, info.epoch);
+            }
+        }
+        os << "DebugPool: " << live_ << " live of " << slots_.size() << " slots seen, epoch " << epoch_ << "\n";
+        for (const auto& [stage, summary] : byStage) {
+            os << "\t" << stage << ": " << summary.count << " live, oldest epoch " << summary.oldestEpoch << "\n";
+        }
+    }
+
+private:
+    enum class SlotState : uint8_t { Free, Live };
+    struct SlotInfo {
+        SlotState state = SlotState::Free;
+        const char* stage = "allocated";
+        uint64_t epoch = 0;         // allocation that handed the slot out last
+    };
+
+    void onAllocate(MsgPtr msg) {
+        if constexpr (!poolWritesFreeSlots<P>) {
+            POOL_UNPOISON(msg, sizeof(Msg));
+        }
+        SlotInfo& info = slots_[msg];
+        if (info.state == SlotState::Live) {
+            throw std::runtime_error(describe("DebugPool: pool handed out a live message", msg, info));
+        }
+        info.state = SlotState::Live;
+        info.stage = "allocated";
+        info.epoch = ++epoch_;
+        ++live_;
+    }
+    void onDeallocate(MsgPtr msg) {
+        SlotInfo& info = checkedSlot(msg, "deallocate");
+        if (info.state != SlotState::Live) {
+            throw std::runtime_error(describe("DebugPool: double free", msg, info));
+        }
+        info.state = SlotState::Free;
+        --live_;
+        if constexpr (!poolWritesFreeSlots<P>) {
+            POOL_POISON(msg, sizeof(Msg));  // still ours: P gets the slot back only after this returns
+        }
+    }
+    SlotInfo& checkedSlot(MsgPtr msg, const char* op) {
+        auto it = slots_.find(msg);
+        if (it == slots_.end()) {
+            std::ostringstream error;
+            error << "DebugPool: " << op << " of " << static_cast<const void*>(msg) << " not from this pool";
+            throw std::runtime_error(error.str());
+        }
+        return it->second;
+    }
+    std::string describe(const std::string& what, MsgPtr msg, const SlotInfo& info) const {
+        std::ostringstream error;
+        error << what << " " << static_cast<const void*>(msg) << ", last held by " << info.stage
+              << ", allocation epoch " << info.epoch;
+        return error.str();
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<MsgPtr, SlotInfo> slots_;
+    uint64_t epoch_ = 0;
+    size_t live_ = 0;
+};
@@ -7,6 +7,20 @@
 #include <string>
 #include <iostream>
 #include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <bit>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "HugePages.hpp"
 
 namespace Const {
 #ifndef HASH_BUCKETS
@@ -25,14 +39,30 @@ concept MyHM = requires(HM hm, typename HM::key_type key, typename HM::value_typ
     { hm[key] } -> std::same_as<typename HM::value_type&>;
 };
 
+// Maps that can also be sized, cleared and iterated. An iteration yields entries with the key and
+// the value as their first two members, so structured bindings work for every map.
+template <typename HM>
+concept MyIterableHM = MyHM<HM> && requires(HM hm, const HM chm) {
+    { chm.size() } -> std::same_as<size_t>;
+    { hm.clear() } -> std::same_as<void>;
+    { hm.end() } -> std::same_as<decltype(hm.begin())>;
+};
+
 /**************************************************************************
 Supported HM types include ChainingHashMap, FixedSizedChainingHashMap,  
-OpenAddressingHashMap and STLHashMap. Check TestHashMap.cpp for usage examples.
+OpenAddressingHashMap, SwissHashMap, RobinHoodHashMap and STLHashMap. Each takes
+an optional Hasher (std::hash, MurmurHash, WyHash or FibonacciHash below) and a
+bucket count at construction, Const::initBuckets by default; HashMap forwards its
+constructor arguments. DenseHashMap and STLHashMap are also MyIterableHM, so
+HashMap offers size(), clear() and iteration for them. ConcurrentHashMap is the
+only one that may be shared between threads. Check TestHashMap.cpp for
+usage examples.
 **************************************************************************/
 template <MyHM HM>
 class HashMap {
 public:
-    HashMap() { }
+    template <typename... Args>
+    explicit HashMap(Args&&... args) : hashmap_(std::forward<Args>(args)...) { }
 	HashMap(HashMap const&) = delete;
 	HashMap& operator=(HashMap const&) = delete;
     HashMap(HashMap&&) = default;
@@ -43,26 +73,72 @@ public:
     bool erase(const typename HM::key_type& key) { return hashmap_.erase(key); }
     HM::value_type* find(const typename HM::key_type& key) { return hashmap_.find(key); }
     HM::value_type& operator[](const typename HM::key_type& key) { return hashmap_[key]; }
+    size_t size() const requires MyIterableHM<HM> { return hashmap_.size(); }
+    void clear() requires MyIterableHM<HM> { hashmap_.clear(); }
+    auto begin() requires MyIterableHM<HM> { return hashmap_.begin(); }
+    auto end() requires MyIterableHM<HM> { return hashmap_.end(); }
 private:
     HM hashmap_;
 };
 
+/**************************************************************************
+Hashers for the Hasher parameter of the maps below. Every map reduces a hash with
+& mask, so only the low bits pick the bucket. libstdc++'s std::hash of integers is
+the identity: sequential ids land in consecutive buckets (ideal locality), but ids
+that share their low bits, such as per-session offsets, all land in one bucket.
+The mixers make every output bit depend on every input bit.
+    MurmurHash    - MurmurHash3 fmix64 finalizer, two multiplies
+    WyHash        - wyhash mum: one 64x64->128 multiply of the key against two secrets
+    FibonacciHash - one multiply by 2^64/phi, rotated so the well-mixed high bits
+                    end up where & mask reads them
+**************************************************************************/
+template <typename Key>
+struct MurmurHash {
+    size_t operator()(const Key& key) const noexcept {
+        uint64_t h = static_cast<uint64_t>(std::hash<Key>()(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+};
+
+template <typename Key>
+struct WyHash {
+    size_t operator()(const Key& key) const noexcept {
+        const uint64_t h = static_cast<uint64_t>(std::hash<Key>()(key));
+        const unsigned __int128 product = static_cast<unsigned __int128>(h ^ 0xa0761d6478bd642full) 
+                                        * (h ^ 0xe7037ed1a0b428dbull);
+        return static_cast<size_t>(static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64));
+    }
+};
+
+template <typename Key>
+struct FibonacciHash {
+    size_t operator()(const Key& key) const noexcept {
+        const uint64_t h = static_cast<uint64_t>(std::hash<Key>()(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(std::rotl(h, 32));
+    }
+};
+
 /**************************************************************************/
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
 class ChainingHashMap {
 public:
     using key_type = Key;
     using value_type = Value;
-    ChainingHashMap() 
-            : table_(Const::initBuckets)
-            , mask_(Const::initBuckets - 1) {
+    explicit ChainingHashMap(size_t buckets = Const::initBuckets) 
+            : table_(buckets)
+            , mask_(buckets - 1) {
         std::cout << "ChainingHashMap initialized " << std::endl;
-        if (Const::initBuckets == 0 || (Const::initBuckets & (Const::initBuckets - 1)) != 0) {
-            throw std::runtime_error("initBuckets must be non-zero and a power of 2");
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be non-zero and a power of 2");
         }     
     }
     Value& operator[](const Key& key) {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         for (auto& node : table_[index]) {
             if (node.key == key) {
                 return node.value;
@@ -72,7 +148,7 @@ public:
         return table_[index].back().value;
     }
     void insert(const Key& key, const Value& value) {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         for (auto& node : table_[index]) {
             if (node.key == key) {
                 node.value = value;
@@ -82,7 +158,7 @@ public:
         table_[index].emplace_back(key, value);
     }
     bool contains(const Key& key) const {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         for (const auto& node : table_[index]) {
             if (node.key == key) {
                 return true;
@@ -91,7 +167,7 @@ public:
         return false;
     }
     bool erase(const Key& key) {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         for (auto& node : table_[index]) {
             if (node.key == key) {
                 table_[index].remove(node);
@@ -101,7 +177,7 @@ public:
         return false;
     }
     Value* find(const Key& key) {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         for (auto& node : table_[index]) {
             if (node.key == key) {
                 return &node.value;
@@ -123,25 +199,26 @@ private:
 };
 
 /**************************************************************************/
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
 class FixedSizedChainingHashMap {
 public:
     using key_type = Key;
     using value_type = Value;
-    FixedSizedChainingHashMap() 
-            : buckets_(Const::initBuckets, nullptr) 
-            , nodesPool_(Const::initBuckets * 16)
-            , mask_(Const::initBuckets - 1) {
+    // nodes bounds the number of keys, 0 means 16 per bucket
+    explicit FixedSizedChainingHashMap(size_t buckets = Const::initBuckets, size_t nodes = 0) 
+            : buckets_(buckets, nullptr) 
+            , nodesPool_(nodes != 0 ? nodes : buckets * 16)
+            , mask_(buckets - 1) {
         std::cout << "FixedSizedChainingHashMap initialized " << std::endl;
-        if (Const::initBuckets == 0 || (Const::initBuckets & (Const::initBuckets - 1)) != 0) {
-            throw std::runtime_error("initBuckets must be non-zero and a power of 2");
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be non-zero and a power of 2");
         }
         for (size_t i = 0; i < nodesPool_.size(); ++i) {
             freeNodes_.push(&nodesPool_[i]);
         }
     }
     Value& operator[](const Key& key) {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         Node* node = buckets_[index];
         Node* previous = nullptr;
         while (node != nullptr) { // Traverse the linked list in the bucket
@@ -168,26 +245,10 @@ public:
         return new_node->value;
     }
     void insert(const Key& key, const Value& value) {
-        size_t index = std::hash<Key>()(key) & mask_;
-        if (freeNodes_.empty()) {
-            throw std::runtime_error("No free nodes available in the pool");
-        }
-        Node* current = freeNodes_.top(); freeNodes_.pop();
-        current->key = key;
-        current->value = value;
-        current->next = nullptr;
-        Node* node = buckets_[index];
-        if (node == nullptr) {
-            buckets_[index] = current;
-            return;
-        }
-        while (node->next != nullptr) {
-            node = node->next;
-        }
-        node->next = current;
+        operator[](key) = value;    // overwrites an existing key, like every other map
     }
     bool contains(const Key& key) const {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         Node* node = buckets_[index];
         while (node != nullptr) {
             if (node->key == key) {
@@ -198,7 +259,7 @@ public:
         return false;
     }
     bool erase(const Key& key) {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         Node* node = buckets_[index];
         Node* prev = nullptr;
         while (node != nullptr) {
@@ -218,7 +279,7 @@ public:
         return false;
     }
     Value* find(const Key& key) {
-        size_t index = std::hash<Key>()(key) & mask_;
+        size_t index = Hasher()(key) & mask_;
         Node* node = buckets_[index];
         while (node != nullptr) {
             if (node->key == key) {
@@ -242,155 +303,817 @@ private:
     size_t mask_ = 0;
 };
 
-/**************************************************************************/
-template <typename Key, typename Value>
+/**************************************************************************
+Linear probing with tombstones. When occupied plus deleted slots pass the load
+factor the table is rebuilt, doubled if more than half of that is live. With
+incrementalRehash the rebuild does not stop the world: the new table is mapped
+lazily, the old one stays readable, and every insert or erase moves the next
+MigrateBatch old slots across. A key lives in exactly one of the two tables, so
+lookups check the new table and then the old one while a migration runs.
+**************************************************************************/
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
 class OpenAddressingHashMap {
 public:
     using key_type = Key;
     using value_type = Value;
-    OpenAddressingHashMap() 
-            : table_(Const::initBuckets)
-            , mask_(Const::initBuckets - 1) {
+    explicit OpenAddressingHashMap(size_t buckets = Const::initBuckets, bool incrementalRehash = false)
+            : incremental_(incrementalRehash) {
         std::cout << "OpenAddressingHashMap initialized " << std::endl;
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be non-zero and a power of 2");
+        }
+        table_ = makeTable(buckets);
+        mask_ = buckets - 1;
     }
     Value& operator[](const Key& key) {
-        size_t index = getHash(key);
-        const size_t originalIndex = index;
-        Node* node = nullptr; // Guarateed that node is not null after the loop
-        while (true) {
-            node = &(table_[index]);
-            if (node->status == Status::EMPTY || node->status == Status::DELETED) {
-                if ((size_ + 1) > table_.size() * maxLoadFactor_) {
-                    reHash();
-                    return (*this)[key];  // re-call operator[] after rehash
-                }
-                node->key_ = key;
-                node->value_ = Value{};
-                node->status = Status::OCCUPIED;
-                ++size_;
-                return node->value_;
-            } 
-            else if (node->status == Status::OCCUPIED && node->key_ == key) {
-                return node->value_;
+        migrateStep();
+        size_t index;
+        if (findSlot(*table_, mask_, key, index)) {
+            return (*table_)[index].value_;
+        }
+        if (oldTable_) {
+            size_t oldIndex;
+            if (findSlot(*oldTable_, oldTable_->size() - 1, key, oldIndex)) {    // move it ahead of the cursor
+                Node& old = (*oldTable_)[oldIndex];
+                Value value = std::move(old.value_);    // place() may finish the migration and drop oldTable_
+                old.status = Status::DELETED;
+                --size_;
+                return place(key, std::move(value));
             }
+        }
+        return place(key, Value{});
+    }
+    void insert(const Key& key, const Value& value) {
+        (*this)[key] = value;
+    }
+    bool contains(const Key& key) const {
+        size_t index;
+        return findSlot(*table_, mask_, key, index) 
+            || (oldTable_ && findSlot(*oldTable_, oldTable_->size() - 1, key, index));
+    }
+    bool erase(const Key& key) {
+        migrateStep();
+        size_t index;
+        if (findSlot(*table_, mask_, key, index)) {
+            (*table_)[index].status = Status::DELETED;
+            --size_;
+            return true;
+        }
+        if (oldTable_ && findSlot(*oldTable_, oldTable_->size() - 1, key, index)) {
+            (*oldTable_)[index].status = Status::DELETED;
+            --size_;
+            return true;
+        }
+        return false;
+    }
+    Value* find(const Key& key) {
+        size_t index;
+        if (findSlot(*table_, mask_, key, index)) {
+            return &(*table_)[index].value_;
+        }
+        if (oldTable_ && findSlot(*oldTable_, oldTable_->size() - 1, key, index)) {
+            return &(*oldTable_)[index].value_;
+        }
+        return nullptr;
+    }
+    bool rehashing() const { return oldTable_ != nullptr; }
+private:
+    static constexpr size_t MigrateBatch = 8;   // old slots moved per insert/erase, >= 2 finishes before the next rehash
+    static constexpr size_t ReleaseBatch = 4096;    // migrated old slots whose pages are returned together
+    enum class Status : uint8_t { EMPTY = 0, OCCUPIED, DELETED };
+    struct Node {
+        Key key_;
+        Value value_;
+        Status status;      // no initializer: an all-zero Node is EMPTY, so fresh pages need no construction
+    };
+    using Table = HugePageBuffer<Node>;
 
-            index = (index + 1) & mask_;
-            if (index == originalIndex) {
-                throw std::runtime_error("HashMap is full");
+    std::unique_ptr<Table> table_;
+    std::unique_ptr<Table> oldTable_;           // being migrated, only while rehashing()
+    size_t cursor_ = 0;                         // next old slot to migrate
+    size_t released_ = 0;                       // old slots below this have had their pages released
+    size_t mask_ = 0;
+    size_t size_ = 0;                           // live keys in both tables
+    size_t used_ = 0;                           // occupied or deleted slots in table_
+    float maxLoadFactor_ = 0.7f;
+    bool incremental_ = false;
+
+    // Incremental tables are left to the kernel's zero pages, so mapping one costs no more than the first
+    // touch of each page; otherwise the table is prefaulted on huge pages up front.
+    std::unique_ptr<Table> makeTable(size_t buckets) const {
+        return std::make_unique<Table>(buckets, incremental_ ? PageOptions{ PageSize::Default4K, -1, false } 
+                                                             : PageOptions{});
+    }
+    size_t getHash(const Key& key, size_t mask) const {
+        return Hasher()(key) & mask;
+    }
+    // True with index at key if found; otherwise index is the first reusable slot of key's run
+    bool findSlot(const Table& table, size_t mask, const Key& key, size_t& index) const {
+        size_t i = getHash(key, mask);
+        size_t firstDeleted = SIZE_MAX;
+        for (size_t probes = 0; probes <= mask; ++probes, i = (i + 1) & mask) {
+            const Node& node = table[i];
+            if (node.status == Status::EMPTY) {
+                index = (firstDeleted != SIZE_MAX) ? firstDeleted : i;
+                return false;
+            }
+            if (node.status == Status::OCCUPIED && node.key_ == key) {
+                index = i;
+                return true;
+            }
+            if (node.status == Status::DELETED && firstDeleted == SIZE_MAX) {
+                firstDeleted = i;
+            }
+        }
+        index = firstDeleted;   // no EMPTY left, the load factor keeps a DELETED one
+        return false;
+    }
+    // Inserts a key known to be absent from both tables
+    Value& place(const Key& key, Value value) {
+        if ((used_ + 1) > table_->size() * maxLoadFactor_) {
+            reHash();
+        }
+        size_t index;
+        findSlot(*table_, mask_, key, index);
+        if (index == SIZE_MAX) {
+            throw std::runtime_error("HashMap is full");
+        }
+        Node& node = (*table_)[index];
+        used_ += (node.status == Status::EMPTY) ? 1 : 0;
+        node.key_ = key;
+        node.value_ = std::move(value);
+        node.status = Status::OCCUPIED;
+        ++size_;
+        return node.value_;
+    }
+    void reHash() {
+        if (oldTable_) {        // only two tables at a time
+            migrate(oldTable_->size());
+        }
+        const size_t buckets = (size_ + 1) > table_->size() * maxLoadFactor_ / 2 ? table_->size() * 2 : table_->size();
+        oldTable_ = std::move(table_);
+        table_ = makeTable(buckets);
+        mask_ = buckets - 1;
+        used_ = 0;
+        cursor_ = 0;
+        released_ = 0;
+        if (!incremental_) {
+            migrate(oldTable_->size());
+        }
+    }
+    inline void migrateStep() {
+        if (oldTable_) {
+            migrate(MigrateBatch);
+        }
+    }
+    void migrate(size_t count) {
+        const size_t end = std::min(oldTable_->size(), cursor_ + count);
+        for (; cursor_ < end; ++cursor_) {
+            Node& old = (*oldTable_)[cursor_];
+            if (old.status == Status::OCCUPIED) {
+                size_t index;
+                findSlot(*table_, mask_, old.key_, index);
+                Node& node = (*table_)[index];
+                used_ += (node.status == Status::EMPTY) ? 1 : 0;
+                node.key_ = std::move(old.key_);
+                node.value_ = std::move(old.value_);
+                node.status = Status::OCCUPIED;
+                old.status = Status::DELETED;   // keeps the rest of its run reachable for lookups
+            }
+        }
+        if constexpr (std::is_trivially_destructible_v<Node>) {
+            if (incremental_ && cursor_ - released_ >= ReleaseBatch) {     // unmapping it all at the end stalls
+                // Released pages read back as EMPTY, so the tombstones of the run holding cursor_
+                // must stay: keys not migrated yet can have their home anywhere in that run
+                size_t runStart = cursor_;
+                while (runStart > released_ && (*oldTable_)[runStart - 1].status != Status::EMPTY) --runStart;
+                released_ = oldTable_->release(released_, runStart);
             }
         }
-        return node->value_;
+        if (cursor_ == oldTable_->size()) {
+            oldTable_.reset();
+        }
+    }
+};
+
+/**************************************************************************
+Swiss-table style open addressing. A separate 1-byte control array holds a 7-bit
+fingerprint of every occupied slot (or EMPTY), and lookups compare 16 control
+bytes at once with SSE2, touching a slot only on a fingerprint match. Probing is
+linear from the home slot, so a key always sits before the first EMPTY after its
+home; erase shifts the following entries back instead of leaving tombstones.
+The table doubles at 7/8 load. The first GroupWidth - 1 control bytes are
+mirrored past the end so a group load never wraps.
+**************************************************************************/
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class SwissHashMap {
+public:
+    using key_type = Key;
+    using value_type = Value;
+    explicit SwissHashMap(size_t buckets = Const::initBuckets) {
+        std::cout << "SwissHashMap initialized " << std::endl;
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be non-zero and a power of 2");
+        }
+        allocate(std::max<size_t>(buckets, GroupWidth));
+    }
+    Value& operator[](const Key& key) {
+        const size_t hash = hashOf(key);
+        size_t index;
+        if (findIndex(key, hash, index)) {
+            return slots_[index].value;
+        }
+        return slots_[insertNew(key, hash)].value;
     }
     void insert(const Key& key, const Value& value) {
-        if ((size_ + 1) > table_.size() * maxLoadFactor_) {
+        (*this)[key] = value;
+    }
+    bool contains(const Key& key) const {
+        size_t index;
+        return findIndex(key, hashOf(key), index);
+    }
+    bool erase(const Key& key) {
+        size_t hole;
+        if (!findIndex(key, hashOf(key), hole)) {
+            return false;
+        }
+        // Backward shift: pull every following entry that may live in the hole closer to its home
+        for (size_t next = (hole + 1) & mask_; ctrl_[next] != EMPTY; next = (next + 1) & mask_) {
+            const size_t home = homeOf(hashOf(slots_[next].key));
+            if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+                slots_[hole] = std::move(slots_[next]);
+                setCtrl(hole, ctrl_[next]);
+                hole = next;
+            }
+        }
+        slots_[hole] = Slot{};
+        setCtrl(hole, EMPTY);
+        --size_;
+        return true;
+    }
+    Value* find(const Key& key) {
+        size_t index;
+        return findIndex(key, hashOf(key), index) ? &slots_[index].value : nullptr;
+    }
+private:
+    static constexpr size_t GroupWidth = 16;
+    static constexpr int8_t EMPTY = -128;   // fingerprints are 0..127
+    struct Slot {
+        Key key{};
+        Value value{};
+    };
+
+    // Homes come from the top bits of a Fibonacci multiply even for a mixing Hasher:
+    // with std::hash (the identity for integers) dense ids would form one long run
+    // that every miss and erase has to scan
+    inline size_t hashOf(const Key& key) const {
+        return Hasher()(key) * 0x9E3779B97F4A7C15ull;
+    }
+    inline size_t homeOf(size_t hash) const { return hash >> shift_; }
+    static inline int8_t fingerprintOf(size_t hash) {
+        return static_cast<int8_t>((hash >> 25) & 0x7F);
+    }
+
+    // Bit i set when control byte pos + i equals byte
+    inline uint32_t matchGroup(size_t pos, int8_t byte) const {
+#ifdef __SSE2__
+        const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&ctrl_[pos]));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GroupWidth; ++i) {
+            mask |= static_cast<uint32_t>(ctrl_[pos + i] == byte) << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Scans group by group from the home slot. On a miss index is the first EMPTY slot, where key belongs.
+    bool findIndex(const Key& key, size_t hash, size_t& index) const {
+        const int8_t fingerprint = fingerprintOf(hash);
+        for (size_t pos = homeOf(hash); ; pos = (pos + GroupWidth) & mask_) {
+            const uint32_t empties = matchGroup(pos, EMPTY);
+            uint32_t matches = matchGroup(pos, fingerprint);
+            if (empties != 0) {
+                matches &= (empties & -empties) - 1;    // the key can't sit past the first EMPTY
+            }
+            while (matches != 0) {
+                const size_t candidate = (pos + std::countr_zero(matches)) & mask_;
+                if (slots_[candidate].key == key) {
+                    index = candidate;
+                    return true;
+                }
+                matches &= matches - 1;
+            }
+            if (empties != 0) {
+                index = (pos + std::countr_zero(empties)) & mask_;
+                return false;
+            }
+        }
+    }
+    size_t insertNew(const Key& key, size_t hash) {
+        if ((size_ + 1) * 8 > capacity_ * 7) {
             reHash();
         }
-        size_t index = getHash(key);
-        const size_t originalIndex = index;
-        while (table_[index].status == Status::OCCUPIED) {
-            if (table_[index].key_ == key) {
-                table_[index].value_ = value;
-                return;
+        size_t index;
+        findIndex(key, hash, index);
+        slots_[index].key = key;
+        slots_[index].value = Value{};
+        setCtrl(index, fingerprintOf(hash));
+        ++size_;
+        return index;
+    }
+    inline void setCtrl(size_t index, int8_t byte) {
+        ctrl_[index] = byte;
+        if (index < GroupWidth - 1) {
+            ctrl_[capacity_ + index] = byte;    // mirror
+        }
+    }
+    void allocate(size_t capacity) {
+        capacity_ = capacity;
+        mask_ = capacity - 1;
+        shift_ = 64 - std::countr_zero(capacity);
+        ctrl_.assign(capacity + GroupWidth - 1, EMPTY);
+        slots_ = std::vector<Slot>(capacity);
+        size_ = 0;
+    }
+    void reHash() {
+        std::vector<int8_t> oldCtrl = std::move(ctrl_);
+        std::vector<Slot> oldSlots = std::move(slots_);
+        allocate(capacity_ * 2);
+        for (size_t i = 0; i < oldSlots.size(); ++i) {
+            if (oldCtrl[i] != EMPTY) {
+                const size_t hash = hashOf(oldSlots[i].key);
+                size_t index;
+                findIndex(oldSlots[i].key, hash, index);
+                slots_[index] = std::move(oldSlots[i]);
+                setCtrl(index, fingerprintOf(hash));
+                ++size_;
             }
-            index = (index + 1) & mask_;
         }
+    }
 
-        table_[index].key_ = key;
-        table_[index].value_ = value;
-        table_[index].status = Status::OCCUPIED;
+    std::vector<int8_t> ctrl_;
+    std::vector<Slot> slots_;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    unsigned shift_ = 0;    // 64 - log2(capacity)
+    size_t size_ = 0;
+};
+
+/**************************************************************************
+Robin Hood open addressing with keys and values stored inline. Every slot records
+its probe distance (1 = at home, 0 = empty) and an insert takes the slot of any
+entry closer to its home than itself, which keeps probe lengths short and even.
+Because a run is ordered by distance, a miss stops at the first entry closer to
+home than the key would be, and erase shifts entries back only until one sits at
+its home. That makes dense, identity-hashed ids safe: they form long runs but a
+lookup or erase never scans past its own neighbourhood. Doubles at 7/8 load.
+**************************************************************************/
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class RobinHoodHashMap {
+public:
+    using key_type = Key;
+    using value_type = Value;
+    explicit RobinHoodHashMap(size_t buckets = Const::initBuckets) {
+        std::cout << "RobinHoodHashMap initialized " << std::endl;
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be non-zero and a power of 2");
+        }
+        allocate(buckets);
+    }
+    Value& operator[](const Key& key) {
+        size_t index = homeOf(key);
+        uint32_t dist = 1;
+        for (; slots_[index].dist >= dist; index = (index + 1) & mask_, ++dist) {
+            if (slots_[index].dist == dist && slots_[index].key == key) {
+                return slots_[index].value;
+            }
+        }
+        if ((size_ + 1) * 8 > slots_.size() * 7) {
+            reHash();
+            return (*this)[key];
+        }
+        place(index, Slot{key, Value{}, dist});
         ++size_;
+        return slots_[index].value;
+    }
+    void insert(const Key& key, const Value& value) {
+        (*this)[key] = value;
     }
     bool contains(const Key& key) const {
-        size_t index = getHash(key);
-        const size_t originalIndex = index;
+        return findIndex(key) != NotFound;
+    }
+    bool erase(const Key& key) {
+        size_t hole = findIndex(key);
+        if (hole == NotFound) {
+            return false;
+        }
+        // Backward shift: every displaced entry moves one slot closer to its home
+        for (size_t next = (hole + 1) & mask_; slots_[next].dist > 1; next = (next + 1) & mask_) {
+            slots_[hole] = std::move(slots_[next]);
+            --slots_[hole].dist;
+            hole = next;
+        }
+        slots_[hole] = Slot{};
+        --size_;
+        return true;
+    }
+    Value* find(const Key& key) {
+        const size_t index = findIndex(key);
+        return index != NotFound ? &slots_[index].value : nullptr;
+    }
+private:
+    static constexpr size_t NotFound = SIZE_MAX;
+    struct Slot {
+        Key key{};
+        Value value{};
+        uint32_t dist = 0;      // probe distance + 1, 0 when empty
+    };
 
-        while (table_[index].status != Status::EMPTY) {
-            if (table_[index].status == Status::OCCUPIED && table_[index].key_ == key) {
-                return true;
+    inline size_t homeOf(const Key& key) const {
+        return Hasher()(key) & mask_;
+    }
+    size_t findIndex(const Key& key) const {
+        size_t index = homeOf(key);
+        for (uint32_t dist = 1; slots_[index].dist >= dist; index = (index + 1) & mask_, ++dist) {
+            if (slots_[index].dist == dist && slots_[index].key == key) {
+                return index;
+            }
+        }
+        return NotFound;    // an empty slot or an entry richer than key ends the run
+    }
+    // Puts entry at index and pushes the displaced entries down the run
+    void place(size_t index, Slot entry) {
+        while (slots_[index].dist != 0) {
+            if (slots_[index].dist < entry.dist) {
+                std::swap(slots_[index], entry);
             }
             index = (index + 1) & mask_;
-            if (index == originalIndex) {
-                break;
+            ++entry.dist;
+        }
+        slots_[index] = std::move(entry);
+    }
+    void allocate(size_t capacity) {
+        slots_ = std::vector<Slot>(capacity);
+        mask_ = capacity - 1;
+        size_ = 0;
+    }
+    void reHash() {
+        std::vector<Slot> oldSlots = std::move(slots_);
+        allocate(oldSlots.size() * 2);
+        for (auto& slot : oldSlots) {
+            if (slot.dist != 0) {
+                size_t index = homeOf(slot.key);
+                uint32_t dist = 1;
+                while (slots_[index].dist >= dist) {    // keys are unique, only find the insert point
+                    index = (index + 1) & mask_;
+                    ++dist;
+                }
+                place(index, Slot{std::move(slot.key), std::move(slot.value), dist});
+                ++size_;
             }
         }
-        return false;
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+};
+
+/**************************************************************************
+Entries live packed in insertion order in a dense array and a linear-probing
+index of (entry, generation) pairs points into it, so iteration walks only the
+live entries and never the buckets. clear() bumps the generation, which turns
+every bucket stale at once: an O(1) reset for tables that are refilled every
+interval. Erase moves the last entry into the hole to keep the array packed and
+leaves a tombstone in the index until the next clear() or rehash. Cleared entries
+are reused by later inserts, so keys that own memory (std::string) keep it.
+References and iteration are invalidated by inserts that grow the array.
+**************************************************************************/
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class DenseHashMap {
+public:
+    using key_type = Key;
+    using value_type = Value;
+    struct Entry {
+        Key key;
+        Value value;
+    };
+    explicit DenseHashMap(size_t buckets = Const::initBuckets) 
+            : index_(buckets)
+            , mask_(buckets - 1) {
+        std::cout << "DenseHashMap initialized " << std::endl;
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be non-zero and a power of 2");
+        }
+    }
+    Value& operator[](const Key& key) {
+        size_t bucket;
+        if (findBucket(key, bucket)) {
+            return entries_[index_[bucket].entry].value;
+        }
+        if ((size_ + tombstones_ + 1) * 2 > index_.size()) {
+            reHash();
+            findBucket(key, bucket);
+        }
+        if (size_ == entries_.size()) {
+            entries_.push_back(Entry{ key, Value{} });
+        }
+        else {      // reuse an entry left behind by clear() or erase()
+            entries_[size_].key = key;
+            entries_[size_].value = Value{};
+        }
+        index_[bucket] = Bucket{ static_cast<uint32_t>(size_), generation_ };
+        return entries_[size_++].value;
+    }
+    void insert(const Key& key, const Value& value) {
+        (*this)[key] = value;
+    }
+    bool contains(const Key& key) const {
+        size_t bucket;
+        return findBucket(key, bucket);
     }
     bool erase(const Key& key) {
-        size_t index = getHash(key);
-        const size_t originalIndex = index;
+        size_t bucket;
+        if (!findBucket(key, bucket)) {
+            return false;
+        }
+        const uint32_t hole = index_[bucket].entry;
+        index_[bucket].entry = Tombstone;
+        ++tombstones_;
+        const uint32_t last = static_cast<uint32_t>(--size_);
+        if (hole != last) {         // keep the array packed
+            size_t lastBucket;
+            findBucket(entries_[last].key, lastBucket);
+            index_[lastBucket].entry = hole;
+            std::swap(entries_[hole], entries_[last]);
+        }
+        return true;
+    }
+    Value* find(const Key& key) {
+        size_t bucket;
+        return findBucket(key, bucket) ? &entries_[index_[bucket].entry].value : nullptr;
+    }
+    size_t size() const { return size_; }
+    void clear() {
+        size_ = 0;
+        tombstones_ = 0;
+        if (++generation_ == 0) {   // wrapped: stale buckets could look current again
+            std::fill(index_.begin(), index_.end(), Bucket{});
+            generation_ = 1;
+        }
+    }
+    Entry* begin() { return entries_.data(); }
+    Entry* end() { return entries_.data() + size_; }
+private:
+    static constexpr uint32_t Tombstone = UINT32_MAX;
+    struct Bucket {
+        uint32_t entry = 0;
+        uint32_t generation = 0;    // empty unless it equals generation_
+    };
 
-        while (table_[index].status != Status::EMPTY) {
-            if (table_[index].status == Status::OCCUPIED && table_[index].key_ == key) {
-                table_[index].status = Status::DELETED;
-                --size_;
-                return true;
+    // True with bucket at key if found; otherwise bucket is the first reusable bucket of key's run
+    bool findBucket(const Key& key, size_t& bucket) const {
+        size_t i = Hasher()(key) & mask_;
+        size_t firstTombstone = SIZE_MAX;
+        while (index_[i].generation == generation_) {
+            const uint32_t entry = index_[i].entry;
+            if (entry == Tombstone) {
+                if (firstTombstone == SIZE_MAX) {
+                    firstTombstone = i;
+                }
             }
-            index = (index + 1) & mask_;
-            if (index == originalIndex) {
-                break;
+            else if (entries_[entry].key == key) {
+                bucket = i;
+                return true;
             }
+            i = (i + 1) & mask_;
         }
-
+        bucket = (firstTombstone != SIZE_MAX) ? firstTombstone : i;
         return false;
     }
-    Value* find(const Key& key) {
-        size_t index = getHash(key);
-        const size_t originalIndex = index;
+    void reHash() {
+        const size_t buckets = (size_ + 1) * 2 > index_.size() / 2 ? index_.size() * 2 : index_.size();
+        index_.assign(buckets, Bucket{});
+        mask_ = buckets - 1;
+        generation_ = 1;
+        tombstones_ = 0;
+        for (size_t entry = 0; entry < size_; ++entry) {
+            size_t i = Hasher()(entries_[entry].key) & mask_;
+            while (index_[i].generation == generation_) {
+                i = (i + 1) & mask_;
+            }
+            index_[i] = Bucket{ static_cast<uint32_t>(entry), generation_ };
+        }
+    }
+
+    std::vector<Entry> entries_;        // [0, size_) live, the rest kept for reuse
+    std::vector<Bucket> index_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    size_t tombstones_ = 0;
+    uint32_t generation_ = 1;
+};
 
-        while (table_[index].status != Status::EMPTY) {
-            if (table_[index].status == Status::OCCUPIED && table_[index].key_ == key) {
-                return &table_[index].value_;
+/**************************************************************************
+Fixed-capacity open-addressing map shared by many threads. Key and Value must be
+trivially copyable (symbols packed into integers, small POD state).
+    reads  - load() and contains() take no lock. Every slot carries a seqlock over
+             its state, key and value; a reader retries a slot it saw mid-write,
+             so it never returns a torn value.
+    writes - insert(), update() and erase() lock one of Stripes mutexes picked by
+             the key's hash, so two writers of the same key are serialized and a
+             key is never inserted twice. A writer then takes the slot itself by
+             moving its sequence from even to odd with a CAS, so writers of
+             different keys only meet on a free slot they both want.
+Erased slots keep their key as a tombstone and are reused by later inserts. The
+table never grows: size it for the peak key count at construction.
+find() and operator[] return the slot's storage to satisfy MyHM. They are safe
+only while no other thread writes that key; concurrent code uses load() and
+update().
+**************************************************************************/
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class ConcurrentHashMap {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>, 
+                  "ConcurrentHashMap copies keys and values under a seqlock");
+public:
+    using key_type = Key;
+    using value_type = Value;
+    explicit ConcurrentHashMap(size_t buckets = Const::initBuckets)
+            : slots_(std::make_unique<Slot[]>(buckets))
+            , mask_(buckets - 1) {
+        std::cout << "ConcurrentHashMap initialized " << std::endl;
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be non-zero and a power of 2");
+        }
+    }
+    // Consistent copy of the value, false if key is absent
+    bool load(const Key& key, Value& out) const {
+        const size_t hash = Hasher()(key);
+        for (size_t i = hash & mask_, probes = 0; probes <= mask_; i = (i + 1) & mask_, ++probes) {
+            const Snapshot snap = read(slots_[i]);
+            if (snap.state == State::Empty) {
+                return false;
             }
-            index = (index + 1) & mask_;
-            if (index == originalIndex) {
-                break;
+            if (snap.state == State::Live && snap.key == key) {
+                out = snap.value;
+                return true;
             }
         }
-        return nullptr;
+        return false;
+    }
+    bool contains(const Key& key) const {
+        Value value;
+        return load(key, value);
+    }
+    void insert(const Key& key, const Value& value) {
+        update(key, [&value](Value& current) { current = value; });
+    }
+    // Applies f to key's value (value-initialized if absent) as one atomic write for readers
+    template <typename F>
+    void update(const Key& key, F&& f) {
+        const size_t hash = Hasher()(key);
+        std::lock_guard<std::mutex> lock(stripeOf(hash));
+        acquire(key, hash, std::forward<F>(f));
+    }
+    bool erase(const Key& key) {
+        const size_t hash = Hasher()(key);
+        std::lock_guard<std::mutex> lock(stripeOf(hash));
+        Slot* slot = findLive(key, hash);
+        if (slot == nullptr) {
+            return false;
+        }
+        const uint32_t seq = lockSlot(*slot);
+        slot->state.store(State::Deleted, std::memory_order_relaxed);
+        slot->seq.store(seq + 2, std::memory_order_release);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
     }
+    Value* find(const Key& key) {
+        Slot* slot = findLive(key, Hasher()(key));
+        return slot != nullptr ? &slot->value : nullptr;
+    }
+    Value& operator[](const Key& key) {
+        const size_t hash = Hasher()(key);
+        std::lock_guard<std::mutex> lock(stripeOf(hash));
+        return acquire(key, hash, [](Value&) { }).value;
+    }
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
 private:
-    enum class Status { EMPTY, OCCUPIED, DELETED };
-    struct Node {
-        Key key_;
-        Value value_;
-        Status status = Status::EMPTY;
+    static constexpr size_t Stripes = 64;
+    enum class State : uint8_t { Empty, Live, Deleted };
+    struct Slot {
+        std::atomic<uint32_t> seq{ 0 };         // odd while the slot is being written
+        std::atomic<State> state{ State::Empty };
+        Key key{};
+        Value value{};
+    };
+    struct Snapshot {
+        State state;
+        Key key;
+        Value value;
+    };
+    struct alignas(64) Stripe {
+        std::mutex mutex;
     };
-    std::vector<Node> table_;
-    size_t size_ = 0;
-    size_t mask_ = 0;
-    float maxLoadFactor_ = 0.7f;
 
-    size_t getHash(const Key& key) const {
-        return std::hash<Key>()(key) & mask_;
+    std::mutex& stripeOf(size_t hash) {
+        return stripes_[(hash ^ (hash >> 17)) & (Stripes - 1)].mutex;
     }
-    void reHash() {
-        std::vector<Node> oldTable_ = std::move(table_);
-        size_t newSize = oldTable_.size() * 2;
-        mask_ = newSize - 1;
-        table_ = std::vector<Node>(newSize);
-        size_ = 0;
-        for (const auto& node : oldTable_) {
-            if (node.status == Status::OCCUPIED) {
-                insert(node.key_, node.value_);
+    // Even sequence before the write; the slot stays odd until the caller stores it + 2
+    static uint32_t lockSlot(Slot& slot) {
+        uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        while ((seq & 1) != 0 || !slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, 
+                                                                  std::memory_order_relaxed)) {
+            if ((seq & 1) != 0) {
+                std::this_thread::yield();
+                seq = slot.seq.load(std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);     // data stores stay behind the odd sequence
+        return seq;
+    }
+    static Snapshot read(const Slot& slot) {
+        while (true) {
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            Snapshot snap{ slot.state.load(std::memory_order_relaxed), slot.key, slot.value };
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                return snap;
             }
         }
     }
+    // Caller holds key's stripe, so no other thread can make key live meanwhile
+    Slot* findLive(const Key& key, size_t hash) {
+        for (size_t i = hash & mask_, probes = 0; probes <= mask_; i = (i + 1) & mask_, ++probes) {
+            const Snapshot snap = read(slots_[i]);
+            if (snap.state == State::Empty) {
+                return nullptr;
+            }
+            if (snap.state == State::Live && snap.key == key) {
+                return &slots_[i];
+            }
+        }
+        return nullptr;
+    }
+    // Slot holding key, claiming the first free one of its run if key is absent, with f applied to
+    // its value. A new key, its value and f's write are published in one odd-sequence window, so
+    // readers never see the key live with a value-initialized value. Caller holds key's stripe.
+    template <typename F>
+    Slot& acquire(const Key& key, size_t hash, F&& f) {
+        if (Slot* slot = findLive(key, hash)) {
+            const uint32_t seq = lockSlot(*slot);
+            f(slot->value);
+            slot->seq.store(seq + 2, std::memory_order_release);
+            return *slot;
+        }
+        for (size_t i = hash & mask_, probes = 0; probes <= mask_; i = (i + 1) & mask_, ++probes) {
+            Slot& slot = slots_[i];
+            if (slot.state.load(std::memory_order_relaxed) == State::Live) {
+                continue;
+            }
+            const uint32_t seq = lockSlot(slot);
+            if (slot.state.load(std::memory_order_relaxed) == State::Live) {    // another key took it first
+                slot.seq.store(seq, std::memory_order_release);
+                continue;
+            }
+            slot.key = key;
+            slot.value = Value{};
+            f(slot.value);
+            slot.state.store(State::Live, std::memory_order_relaxed);
+            slot.seq.store(seq + 2, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+        throw std::runtime_error("ConcurrentHashMap is full");
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    std::array<Stripe, Stripes> stripes_;
+    alignas(64) std::atomic<size_t> size_{ 0 };
 };
 
 /**************************************************************************/
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
 class STLHashMap {
 public:
     using key_type = Key;
     using value_type = Value;
-    STLHashMap() {
+    explicit STLHashMap(size_t buckets = 0) {
         std::cout << "STLHashMap initialized " << std::endl;
+        map_.reserve(buckets);
     }
     Value& operator[](const Key& key) {
         return map_[key];
     }
     void insert(const Key& key, const Value& value) {
-        map_.insert({key, value});
+        map_.insert_or_assign(key, value);
     }
     bool contains(const Key& key) const {
         return map_.contains(key);
@@ -402,8 +1125,12 @@ public:
         auto it = map_.find(key);
         return it != map_.end() ? &it->second : nullptr;
     }
+    size_t size() const { return map_.size(); }
+    void clear() { map_.clear(); }
+    auto begin() { return map_.begin(); }
+    auto end() { return map_.end(); }
 private:
-    std::unordered_map<Key, Value> map_;
+    std::unordered_map<Key, Value, Hasher> map_;
 };
 
 #ifdef USE_ABSL_FLAT_HASH_MAP 
@@ -427,7 +1154,7 @@ AbslFlatHashMap initialized
 */ 
 #include "abseil-cpp/absl/container/flat_hash_map.h"
 /**************************************************************************/
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Hasher = absl::Hash<Key>>
 class AbslFlatHashMap {
 public:
     using key_type = Key;
@@ -454,7 +1181,7 @@ public:
     }
 
 private:
-    absl::flat_hash_map<Key, Value> map_;
+    absl::flat_hash_map<Key, Value, Hasher> map_;
 };
 #endif
 
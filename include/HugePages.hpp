@@ -0,0 +1,160 @@
+#pragma once
+
+#include <new>
+#include <string>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <filesystem>
+#include <type_traits>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mman.h>
+
+enum class PageSize : size_t {
+    Default4K = size_t(4) << 10,
+    Huge2M = size_t(2) << 20,
+    Huge1G = size_t(1) << 30
+};
+
+/**************************************************************************
+How a HugePageBuffer is backed.
+    pageSize - Huge2M/Huge1G try reserved huge pages (MAP_HUGETLB) first and fall
+               back to normal pages with a transparent huge page hint
+    numaNode - bind the memory to this node (mbind), -1 leaves it to first touch
+    prefault - fault every page in at construction rather than on first use
+**************************************************************************/
+struct PageOptions {
+    PageSize pageSize = PageSize::Huge2M;
+    int numaNode = -1;
+    bool prefault = true;
+};
+
+// NUMA node of a cpu from sysfs, -1 if unknown. Use it to place a buffer next to its consumer.
+inline int numaNodeOfCpu(int cpu) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path cpuDir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    for (const auto& entry : fs::directory_iterator(cpuDir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) == 0) {
+            return std::stoi(name.substr(4));
+        }
+    }
+    return -1;
+}
+
+/**************************************************************************
+Fixed-size array of T backed by an anonymous mapping placed according to
+PageOptions. Elements are constructed at allocation time; trivially constructible
+elements of a buffer that is not prefaulted are left to the kernel's zero pages.
+The mapping is rounded to the page size actually obtained, so a small buffer
+that falls back to normal pages costs 4K pages, not a whole huge page.
+**************************************************************************/
+template <typename T>
+class HugePageBuffer {
+public:
+    explicit HugePageBuffer(size_t count, PageOptions options = {})
+            : size_(count) {
+        if (count == 0) {
+            throw std::invalid_argument("HugePageBuffer size must be greater than zero.");
+        }
+        void* mem = MAP_FAILED;
+        if (options.pageSize != PageSize::Default4K) {
+            // Pages must not be faulted in before mbind() has set the policy
+            const int populate = (options.prefault && options.numaNode < 0) ? MAP_POPULATE : 0;
+            const int hugeFlag = (options.pageSize == PageSize::Huge1G) ? MAP_HUGE_1GB : MAP_HUGE_2MB;
+            pageSize_ = static_cast<size_t>(options.pageSize);
+            bytes_ = roundToPage(count * sizeof(T));
+            mem = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | hugeFlag | populate, -1, 0);
+            hugePages_ = (mem != MAP_FAILED);
+        }
+        if (mem == MAP_FAILED) {    // no reserved huge pages, use THP if the kernel allows it
+            pageSize_ = static_cast<size_t>(PageSize::Default4K);
+            bytes_ = roundToPage(count * sizeof(T));
+            // Not populated here: THP only applies to pages faulted in after the madvise() below
+            mem = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            if (options.pageSize != PageSize::Default4K && bytes_ >= static_cast<size_t>(PageSize::Huge2M)) {
+                madvise(mem, bytes_, MADV_HUGEPAGE);
+            }
+        }
+        data_ = static_cast<T*>(mem);
+        if (options.numaNode >= 0) {
+            bindToNode(options.numaNode);
+        }
+        if (options.prefault || !std::is_trivially_default_constructible_v<T>) {
+            for (size_t i = 0; i < size_; ++i) {
+                new (&data_[i]) T();    // also prefaults, after madvise() and mbind()
+            }
+        }
+    }
+    ~HugePageBuffer() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < size_; ++i) {
+                data_[i].~T();
+            }
+        }
+        munmap(data_, bytes_);
+    }
+    HugePageBuffer(HugePageBuffer const&) = delete;
+    HugePageBuffer& operator=(HugePageBuffer const&) = delete;
+
+    inline T& operator[](size_t index) { return data_[index]; }
+    inline const T& operator[](size_t index) const { return data_[index]; }
+    inline T* data() { return data_; }
+    inline size_t size() const { return size_; }
+    bool hugePages() const { return hugePages_; }   // true when backed by explicit huge pages
+    size_t pageSize() const { return pageSize_; }   // page size of the mapping actually obtained
+
+    // Hands the pages lying wholly inside elements [begin, end) back to the kernel; they read as
+    // zero afterwards. Lets a buffer that is being drained shrink gradually instead of in one munmap.
+    // Returns the element the next release should start from: begin when no whole page was covered
+    // (or the kernel refused), so a 1GB page is only released once a whole page of it is drained.
+    size_t release(size_t begin, size_t end) requires std::is_trivially_destructible_v<T> {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(data_);
+        const uintptr_t first = (base + begin * sizeof(T) + pageSize_ - 1) & ~(pageSize_ - 1);
+        const uintptr_t last = (base + end * sizeof(T)) & ~(pageSize_ - 1);
+        if (first >= last) {
+            return begin;
+        }
+        if (madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED) != 0) {
+            std::cerr << "HugePageBuffer: madvise(MADV_DONTNEED) failed: " << std::strerror(errno) << "\n";
+            return begin;
+        }
+        return (last - base) / sizeof(T);
+    }
+
+private:
+    size_t roundToPage(size_t bytes) const { return (bytes + pageSize_ - 1) & ~(pageSize_ - 1); }
+
+    void bindToNode(int node) {
+        constexpr int MPOL_BIND_MODE = 2;       // MPOL_BIND, numaif.h is not always installed
+        constexpr unsigned MPOL_MF_MOVE_FLAG = 2;
+        constexpr size_t maskBits = 1024;
+        if (node >= static_cast<int>(maskBits)) {
+            throw std::invalid_argument("NUMA node out of range");
+        }
+        unsigned long nodeMask[maskBits / (8 * sizeof(unsigned long))] = {};
+        nodeMask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+        if (syscall(SYS_mbind, data_, bytes_, MPOL_BIND_MODE, nodeMask, maskBits + 1, MPOL_MF_MOVE_FLAG) != 0) {
+            std::cerr << "HugePageBuffer: mbind to NUMA node " << node << " failed, using first-touch placement\n";
+        }
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t bytes_ = 0;
+    size_t pageSize_ = static_cast<size_t>(PageSize::Default4K);
+    bool hugePages_ = false;
+};
+
+/**************************************************************************/
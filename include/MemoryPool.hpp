@@ -4,10 +4,20 @@
 #include <iostream>
 #include <vector>
 #include <stack>
+#include <deque>
+#include <thread>
+#include <condition_variable>
 #include <atomic>
 #include <concepts>
+#include <span>
+#include <memory>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
 #include <boost/pool/object_pool.hpp>
 
+#include "HugePages.hpp"
+
 namespace Const {
 #ifndef POOL_MSG_COUNT
     constexpr size_t poolMsgCount = 1 << 20; // 1M - Default message count in the pool
@@ -17,25 +27,45 @@ namespace Const {
 };
 
 template <typename T>
-concept MyPool = requires(T pool, typename T::MsgPtr msg) {
+concept MyPool = requires(T pool, typename T::MsgPtr msg, typename T::MsgPtr* out, 
+                          std::span<const typename T::MsgPtr> msgs) {
     { pool.allocate() } -> std::convertible_to<typename T::MsgPtr>;
     { pool.deallocate(msg) } -> std::same_as<void>;
+    { pool.allocate_bulk(size_t{}, out) } -> std::convertible_to<size_t>;   // fills up to n, returns count
+    { pool.deallocate_bulk(msgs) } -> std::same_as<void>;
 };
 
+// Records that stage now holds msg. Compiles to nothing unless the pool tracks owners (DebugPool).
+template <typename Pool>
+inline void trackOwner(Pool& pool, typename Pool::MsgPtr msg, const char* stage) {
+    if constexpr (requires { pool.trackOwner(msg, stage); }) {
+        pool.trackOwner(msg, stage);
+    }
+}
+
 /**************************************************************************
-Supported Q types include BoostPool, CustomLockedPool, CustomLockFreePool and
-LockFreeThreadSafePool. Check TestPool.cpp for usage examples.
+Supported Q types include BoostPool, CustomLockedPool, CustomLockFreePool,
+LockFreeThreadSafePool and SegmentedPool. Check TestPool.cpp for usage examples.
+Constructor arguments (slot count, PageOptions) are forwarded to the pool.
 **************************************************************************/
 template <MyPool P, bool ThreadSafe = false>
 class MemoryPool {
 public:
-    MemoryPool() { }
+    template <typename... Args>
+        requires std::constructible_from<P, Args...>
+    explicit MemoryPool(Args&&... args) : pool_(std::forward<Args>(args)...) { }
     P::MsgPtr allocate() {
         return pool_.allocate();
     }
     void deallocate(P::MsgPtr msg) {
         pool_.deallocate(msg);
     }
+    size_t allocate_bulk(size_t n, P::MsgPtr* out) {
+        return pool_.allocate_bulk(n, out);
+    }
+    void deallocate_bulk(std::span<const typename P::MsgPtr> msgs) {
+        pool_.deallocate_bulk(msgs);
+    }
 private:
     P pool_;
 };
@@ -64,6 +94,22 @@ public:
             pool_.destroy(obj);
         }
     }
+    size_t allocate_bulk(size_t n, MsgPtr* out) {
+        std::unique_lock<std::mutex> lock(mtx_, std::defer_lock);
+        if constexpr (ThreadSafe) lock.lock();
+        size_t count = 0;
+        while (count < n && (out[count] = pool_.construct()) != nullptr) {
+            ++count;
+        }
+        return count;
+    }
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        std::unique_lock<std::mutex> lock(mtx_, std::defer_lock);
+        if constexpr (ThreadSafe) lock.lock();
+        for (MsgPtr obj : msgs) {
+            pool_.destroy(obj);
+        }
+    }
 private:
     boost::object_pool<Msg> pool_;
     std::mutex mtx_; // Only used if ThreadSafe is true
@@ -74,9 +120,10 @@ template <class Msg, bool ThreadSafe = true>
 class CustomLockedPool {
 public:
     using MsgPtr = Msg*;
-    CustomLockedPool()
-            : pool_(Const::poolMsgCount) {
-        std::cout << "CustomLockedPool initialized for type: " << typeid(Msg).name() << "\n";
+    explicit CustomLockedPool(size_t count = Const::poolMsgCount, PageOptions options = {})
+            : pool_(count, options) {
+        std::cout << "CustomLockedPool initialized for type: " << typeid(Msg).name()
+                  << (pool_.hugePages() ? " on huge pages" : "") << "\n";
         for (size_t i = 0; i < pool_.size(); ++i) {
             freeMsgs_.push(&pool_[i]);
         }
@@ -105,138 +152,604 @@ public:
             freeMsgs_.push(msg);
         }
     }
+    size_t allocate_bulk(size_t n, MsgPtr* out) {    // one lock for the whole batch, never throws
+        std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+        if constexpr (ThreadSafe) lock.lock();
+        size_t count = 0;
+        while (count < n && !freeMsgs_.empty()) {
+            out[count++] = freeMsgs_.top(); freeMsgs_.pop();
+        }
+        return count;
+    }
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+        if constexpr (ThreadSafe) lock.lock();
+        for (MsgPtr msg : msgs) {
+            freeMsgs_.push(msg);
+        }
+    }
 private:
-    std::vector<Msg> pool_;
-    std::stack<MsgPtr> freeMsgs_;
+    HugePageBuffer<Msg> pool_;
+    std::stack<MsgPtr, std::vector<MsgPtr>> freeMsgs_;
     std::mutex mutex_;  // only used when ThreadSafe = true
 };
 
-/**************************************************************************/
+/**************************************************************************
+Free slots live in a bounded MPMC ring (Vyukov): every cell carries a sequence
+number, allocate() claims the next full cell by CAS on head_ and deallocate()
+the next empty one by CAS on tail_. Positions are 64-bit and only ever grow and
+a cell is read or written only by the thread whose sequence check matched, so a
+stale pointer can never be handed out twice (no ABA). The ring has a power of
+two of cells >= count; a deallocate that finds it full is a double free. A cell
+whose sequence lags because another thread is between its CAS and its publish
+is waited for rather than reported as empty or full.
+**************************************************************************/
 template <class Msg, bool ThreadSafe = true> 
 class CustomLockFreePool {
 public:
     using MsgPtr = Msg*;
-    CustomLockFreePool()
-            : pool_(Const::poolMsgCount)
-            , freeMsgs_(Const::poolMsgCount)
-            , head_(Const::poolMsgCount - 1) {
+    explicit CustomLockFreePool(size_t count = Const::poolMsgCount, PageOptions options = {})
+            : pool_(count, options)
+            , cells_(std::bit_ceil(count), options)
+            , mask_(std::bit_ceil(count) - 1) {
         std::cout << "CustomLockFreePool initialized for type: " << 
-            typeid(Msg).name() << "\n";
+            typeid(Msg).name() << (pool_.hugePages() ? " on huge pages" : "") << "\n";
         if constexpr (!ThreadSafe)
             std::cout << "Warning: CustomLockFreePool is thread-safe always\n";
-        for (size_t i = 0; i < pool_.size(); ++i) {
-            freeMsgs_[i] = &pool_[i];
+        for (size_t i = 0; i < cells_.size(); ++i) {
+            cells_[i].seq.store(i < count ? i + 1 : i, std::memory_order_relaxed);
+            cells_[i].msg = i < count ? &pool_[i] : nullptr;
         }
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(count, std::memory_order_relaxed);
     }
     MsgPtr allocate() {
-        int64_t currentHead = head_.load(std::memory_order_acquire);
-        while (currentHead >= 0) {
-            MsgPtr msg = freeMsgs_[static_cast<size_t>(currentHead)];
-            // try to pop the head atomically
-            if (head_.compare_exchange_weak(currentHead, currentHead - 1,
-                    std::memory_order_acquire, std::memory_order_relaxed)) {
-                return msg;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            const int64_t diff = static_cast<int64_t>(cell.seq.load(std::memory_order_acquire)) - 
+                                 static_cast<int64_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    MsgPtr msg = cell.msg;
+                    cell.seq.store(pos + cells_.size(), std::memory_order_release);
+                    return msg;
+                }
+            }
+            else if (diff < 0) {
+                if (tail_.load(std::memory_order_acquire) <= pos) {
+                    return nullptr;     // no free slot
+                }
+                std::this_thread::yield();
+                pos = head_.load(std::memory_order_relaxed);   // a free is still publishing this cell
+            }
+            else {
+                pos = head_.load(std::memory_order_relaxed);
             }
-            // currentHead updated by compare_exchange_weak, loop again
         }
-        return nullptr;
     }
     void deallocate(MsgPtr msg) {
         if (msg == nullptr) {
             throw std::runtime_error("Cannot deallocate a null message");
         }
-        int64_t currentHead = head_.load(std::memory_order_relaxed);
+        size_t pos = tail_.load(std::memory_order_relaxed);
         while (true) {
-            int64_t nextHead = currentHead + 1;
-            if (nextHead >= static_cast<int64_t>(Const::poolMsgCount)) {
-                throw std::runtime_error("Pool overflow on deallocate");
+            Cell& cell = cells_[pos & mask_];
+            const int64_t diff = static_cast<int64_t>(cell.seq.load(std::memory_order_acquire)) - 
+                                 static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.msg = msg;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return;
+                }
             }
-            freeMsgs_[static_cast<size_t>(nextHead)] = msg;
-            if (head_.compare_exchange_weak(currentHead, nextHead,
-                    std::memory_order_release, std::memory_order_relaxed)) {
-                return;
+            else if (diff < 0) {
+                if (static_cast<int64_t>(pos - head_.load(std::memory_order_acquire)) >= static_cast<int64_t>(cells_.size())) {
+                    throw std::runtime_error("Pool overflow on deallocate");
+                }
+                std::this_thread::yield();
+                pos = tail_.load(std::memory_order_relaxed);   // an allocate is still recycling this cell
+            }
+            else {
+                pos = tail_.load(std::memory_order_relaxed);
             }
-            // currentHead updated by compare_exchange_weak, retry
+        }
+    }
+    // Claims a run of up to n full cells with a single head_ CAS
+    size_t allocate_bulk(size_t n, MsgPtr* out) {
+        if (n == 0) return 0;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (true) {
+            count = 0;
+            while (count < n && cells_[(pos + count) & mask_].seq.load(std::memory_order_acquire) == pos + count + 1) {
+                ++count;
+            }
+            if (count == 0) {
+                const size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+                if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1) < 0 && 
+                        tail_.load(std::memory_order_acquire) <= pos) {
+                    return 0;
+                }
+                pos = head_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (head_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            out[i] = cell.msg;
+            cell.seq.store(pos + i + cells_.size(), std::memory_order_release);
+        }
+        return count;
+    }
+    // Claims a run of empty cells with a single tail_ CAS, repeats until the whole batch is in
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        while (!msgs.empty()) {
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            size_t count = 0;
+            while (true) {
+                count = 0;
+                while (count < msgs.size() && cells_[(pos + count) & mask_].seq.load(std::memory_order_acquire) == pos + count) {
+                    ++count;
+                }
+                if (count == 0) {
+                    const size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+                    if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos) < 0 && 
+                            static_cast<int64_t>(pos - head_.load(std::memory_order_acquire)) >= static_cast<int64_t>(cells_.size())) {
+                        throw std::runtime_error("Pool overflow on deallocate_bulk");
+                    }
+                    pos = tail_.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (tail_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                Cell& cell = cells_[(pos + i) & mask_];
+                cell.msg = msgs[i];
+                cell.seq.store(pos + i + 1, std::memory_order_release);
+            }
+            msgs = msgs.subspan(count);
         }
     }
 private:
-    std::vector<Msg> pool_;
-    std::vector<MsgPtr> freeMsgs_;
-    alignas(64) std::atomic<int64_t> head_;
+    struct Cell {
+        std::atomic<size_t> seq;
+        MsgPtr msg;
+    };
+    HugePageBuffer<Msg> pool_;
+    HugePageBuffer<Cell> cells_;
+    const size_t mask_;
+    alignas(64) std::atomic<size_t> head_{ 0 };  // next cell to allocate from
+    alignas(64) std::atomic<size_t> tail_{ 0 };  // next cell to free into
 };
 
-/**************************************************************************/
-template <typename Msg, bool ThreadSafe = true>
+/**************************************************************************
+Tagged-index Treiber stack over a preallocated array. With MagazineSize = N > 0
+every thread keeps a private magazine of up to 2N free slots and only touches the
+shared head_ to take or return N slots at a time with a single CAS, so a thread
+that only frees (e.g. the DB writer) returns slots in bulk instead of fighting
+the allocating thread for head_ on every message. Slots cached in a magazine are
+invisible to other threads until it spills or its thread exits, so size the pool
+with 2N slots of headroom per thread.
+**************************************************************************/
+template <typename Msg, bool ThreadSafe = true, size_t MagazineSize = 0>
 class LockFreeThreadSafePool {
 public:
     using MsgPtr = Msg*;
-    LockFreeThreadSafePool() 
-            : pool_(Const::poolMsgCount)
-            , nextFree_(Const::poolMsgCount) {
-        for (size_t i = 0; i < Const::poolMsgCount; ++i) {
-            nextFree_[i] = i - 1;
+    explicit LockFreeThreadSafePool(size_t count = Const::poolMsgCount, PageOptions options = {})
+            : pool_(count, options)
+            , nextFree_(count, options) {
+        if (count >= EMPTY_INDEX) {
+            throw std::invalid_argument("LockFreeThreadSafePool count must fit in 32 bits");
+        }
+        for (size_t i = 0; i < count; ++i) {
+            nextFree_[i].store(i == 0 ? EMPTY_INDEX : i - 1, std::memory_order_relaxed);
+        }
+        head_.store(pack(count - 1, 0), std::memory_order_relaxed);
+        if constexpr (MagazineSize > 0) {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            livePools().push_back(uid_);
+        }
+    }
+    ~LockFreeThreadSafePool() {
+        if constexpr (MagazineSize > 0) {   // threads that exit later must not flush into this pool
+            std::lock_guard<std::mutex> lock(registryMutex());
+            std::erase(livePools(), uid_);
         }
-        head_.store(pack(Const::poolMsgCount - 1, 0), std::memory_order_relaxed);
     }
+    LockFreeThreadSafePool(LockFreeThreadSafePool const&) = delete;
+    LockFreeThreadSafePool& operator=(LockFreeThreadSafePool const&) = delete;
 
     MsgPtr allocate() {
+        if constexpr (MagazineSize > 0) {
+            Magazine& mag = localMagazine();
+            if (mag.count == 0) [[unlikely]] {
+                mag.count = popChain(MagazineSize, [&](size_t i, size_t index) { mag.slots[i] = index; });
+                if (mag.count == 0) return nullptr;
+            }
+            return &pool_[mag.slots[--mag.count]];
+        }
+        else {
+            MsgPtr msg = nullptr;
+            popChain(1, [&](size_t, size_t index) { msg = &pool_[index]; });
+            return msg;
+        }
+    }
+
+    void deallocate(MsgPtr msg) {
+        if (msg == nullptr) {
+            throw std::runtime_error("Cannot deallocate nullptr");
+        }
+        const size_t index = static_cast<size_t>(msg - &pool_[0]);
+        if constexpr (MagazineSize > 0) {
+            Magazine& mag = localMagazine();
+            if (mag.count == 2 * MagazineSize) [[unlikely]] {  // spill the older half
+                pushChain(MagazineSize, [&](size_t i) { return mag.slots[i]; });
+                std::copy(mag.slots + MagazineSize, mag.slots + 2 * MagazineSize, mag.slots);
+                mag.count = MagazineSize;
+            }
+            mag.slots[mag.count++] = index;
+        }
+        else {
+            pushChain(1, [&](size_t) { return index; });
+        }
+    }
+    // Bulk calls bypass the magazine and splice the whole batch with a single head_ CAS
+    size_t allocate_bulk(size_t n, MsgPtr* out) {
+        if (n == 0) return 0;
+        return popChain(n, [&](size_t i, size_t index) { out[i] = &pool_[index]; });
+    }
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        if (msgs.empty()) return;
+        pushChain(msgs.size(), [&](size_t i) { return static_cast<size_t>(msgs[i] - &pool_[0]); });
+    }
+private:
+    static constexpr size_t INDEX_MASK = 0xFFFFFFFF;
+    static constexpr size_t EMPTY_INDEX = INDEX_MASK;
+    static constexpr size_t TAG_SHIFT = 32;
+
+    inline size_t pack(size_t index, uint32_t tag) {
+        return (static_cast<size_t>(tag) << TAG_SHIFT) | (static_cast<uint32_t>(index));
+    }
+
+    inline void unpack(size_t packed, size_t &index, uint32_t &tag) {
+        index = static_cast<size_t>(packed & INDEX_MASK);
+        tag = static_cast<uint32_t>(packed >> TAG_SHIFT);
+    }
+
+    // Detaches up to count slots from the top of the free list with one CAS, returns how many.
+    // store(i, index) receives the i-th slot and may be called again for the same i on a retry.
+    template <typename Store>
+    size_t popChain(size_t count, Store&& store) {
         size_t oldHead = head_.load(std::memory_order_acquire);
         while (true) {
             size_t index;
             uint32_t tag;
             unpack(oldHead, index, tag);
-
-            if (index == -1) {
-                return nullptr;
+            size_t taken = 0;
+            while (index != EMPTY_INDEX && taken < count) {
+                store(taken++, index);
+                index = nextFree_[index].load(std::memory_order_relaxed);
             }
-
-            size_t nextIndex = nextFree_[index];
-
-            size_t newHead = pack(nextIndex, tag + 1);
-
-            if (head_.compare_exchange_weak(oldHead, newHead,
+            if (taken == 0) {
+                return 0;
+            }
+            if (head_.compare_exchange_weak(oldHead, pack(index, tag + 1),
                         std::memory_order_acq_rel, std::memory_order_acquire)) {
-                return &pool_[index];
+                return taken;
             }
-            // else retry with updated oldHead
+            // else retry with updated oldHead, the chain read above may be stale
         }
     }
 
-    void deallocate(MsgPtr msg) {
-        if (msg == nullptr) {
-            throw std::runtime_error("Cannot deallocate nullptr");
+    // Links count slots, indexAt(i) being the i-th, into a chain and pushes it onto the free list with one CAS
+    template <typename IndexAt>
+    void pushChain(size_t count, IndexAt&& indexAt) {
+        const size_t first = indexAt(0);
+        size_t last = first;
+        for (size_t i = 1; i < count; ++i) {
+            const size_t index = indexAt(i);
+            nextFree_[last].store(index, std::memory_order_relaxed);
+            last = index;
         }
-        size_t index = (size_t)(msg - &pool_[0]);
-
         size_t oldHead = head_.load(std::memory_order_acquire);
         while (true) {
             size_t headIndex;
             uint32_t tag;
             unpack(oldHead, headIndex, tag);
-            nextFree_[index] = headIndex;
-            size_t newHead = pack(index, tag + 1);
-            if (head_.compare_exchange_weak(oldHead, newHead,
+            nextFree_[last].store(headIndex, std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(oldHead, pack(first, tag + 1),
                         std::memory_order_acq_rel, std::memory_order_acquire)) {
                 return;
             }
         }
     }
+
+    struct Magazine {
+        size_t count = 0;
+        size_t slots[MagazineSize > 0 ? 2 * MagazineSize : 1];
+    };
+
+    // Per-thread list of (pool uid, magazine). Uids are never reused, so entries of
+    // destroyed pools are simply skipped when the thread exits.
+    struct ThreadCache {
+        struct Entry {
+            uint64_t uid;
+            LockFreeThreadSafePool* pool;
+            Magazine* mag;
+        };
+        std::vector<Entry> entries;
+        uint64_t lastUid = 0;
+        Magazine* lastMag = nullptr;
+        ~ThreadCache() {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for (const Entry& entry : entries) {
+                if (std::ranges::find(livePools(), entry.uid) != livePools().end() && entry.mag->count > 0) {
+                    entry.pool->pushChain(entry.mag->count, [&](size_t i) { return entry.mag->slots[i]; });
+                    entry.mag->count = 0;
+                }
+            }
+        }
+    };
+
+    inline Magazine& localMagazine() {
+        thread_local ThreadCache cache;
+        if (cache.lastUid == uid_) [[likely]] {
+            return *cache.lastMag;
+        }
+        Magazine* mag = nullptr;
+        for (const auto& entry : cache.entries) {
+            if (entry.uid == uid_) mag = entry.mag;
+        }
+        if (mag == nullptr) {
+            std::lock_guard<std::mutex> lock(magazinesMutex_);
+            mag = magazines_.emplace_back(std::make_unique<Magazine>()).get();
+            cache.entries.push_back({ uid_, this, mag });
+        }
+        cache.lastUid = uid_;
+        cache.lastMag = mag;
+        return *mag;
+    }
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    static std::vector<uint64_t>& livePools() {
+        static std::vector<uint64_t> uids;
+        return uids;
+    }
+    static inline std::atomic<uint64_t> nextUid_{ 1 };
+
+    HugePageBuffer<Msg> pool_;
+    HugePageBuffer<std::atomic<size_t>> nextFree_;
+    alignas(64) std::atomic<size_t> head_; // lower 32 bits: index, upper 32 bits: tag
+    alignas(64) const uint64_t uid_ = nextUid_.fetch_add(1, std::memory_order_relaxed);
+    std::mutex magazinesMutex_;
+    std::vector<std::unique_ptr<Magazine>> magazines_;  // owned here, used by one thread each
+};
+
+/**************************************************************************
+Growable pool made of slabs of SlabSize slots. Slabs are never moved or released
+before the pool is destroyed, so slot addresses stay stable and growing never stops
+other threads. A background thread keeps headroomSlabs spare slabs mapped, prefaulted
+and linked; an allocate() that finds the free list empty splices a spare slab in with
+one CAS and wakes the thread to replace it. Only when no spare is ready does the
+allocating thread map a slab itself. Each slot carries its global index behind the
+message, so the free list is the same tagged-index Treiber stack as
+LockFreeThreadSafePool. allocate() returns nullptr only once MaxSlabs are in use.
+**************************************************************************/
+template <typename Msg, size_t SlabSize = (1 << 14), size_t MaxSlabs = 4096>
+class SegmentedPool {
+    static_assert((SlabSize & (SlabSize - 1)) == 0, "SlabSize must be a power of 2");
+    static_assert(SlabSize * MaxSlabs < 0xFFFFFFFF, "Slot indices must fit in 32 bits");
+public:
+    using MsgPtr = Msg*;
+    static constexpr size_t slabSlots = SlabSize;
+    explicit SegmentedPool(size_t initialSlabs = 1, size_t headroomSlabs = 1, PageOptions options = {})
+            : headroomSlabs_(headroomSlabs)
+            , options_(options) {
+        if (initialSlabs == 0 || initialSlabs + headroomSlabs > MaxSlabs) {
+            throw std::invalid_argument("SegmentedPool needs 1 to MaxSlabs initial and headroom slabs");
+        }
+        std::cout << "SegmentedPool initialized for type: " << typeid(Msg).name() << " with " 
+                  << initialSlabs << " slabs of " << SlabSize << " slots, " << headroomSlabs << " spare\n";
+        for (size_t i = 0; i < initialSlabs; ++i) {
+            const Chain chain = mapSlab(slabCount_.fetch_add(1, std::memory_order_relaxed));
+            pushChain(chain.first, chain.last);
+        }
+        for (size_t i = 0; i < headroomSlabs_; ++i) {
+            spare_.push_back(mapSlab(slabCount_.fetch_add(1, std::memory_order_relaxed)));
+        }
+        if (headroomSlabs_ > 0) {
+            growThread_ = std::thread(&SegmentedPool::growLoop, this);
+        }
+    }
+    ~SegmentedPool() {
+        {
+            std::lock_guard<std::mutex> lock(growMutex_);
+            stopGrowing_ = true;
+        }
+        growCv_.notify_one();
+        if (growThread_.joinable()) {
+            growThread_.join();
+        }
+    }
+    SegmentedPool(SegmentedPool const&) = delete;
+    SegmentedPool& operator=(SegmentedPool const&) = delete;
+
+    MsgPtr allocate() {
+        MsgPtr msg = nullptr;
+        while (popChain(1, [&](size_t, Slot& slot) { msg = &slot.msg; }) == 0) {
+            if (!grow()) [[unlikely]] {
+                return nullptr;
+            }
+        }
+        return msg;
+    }
+    void deallocate(MsgPtr msg) {
+        if (msg == nullptr) {
+            throw std::runtime_error("Cannot deallocate nullptr");
+        }
+        const size_t index = slotOf(msg).index;
+        pushChain(index, index);
+    }
+    size_t allocate_bulk(size_t n, MsgPtr* out) {
+        if (n == 0) return 0;
+        size_t count = 0;
+        while ((count = popChain(n, [&](size_t i, Slot& slot) { out[i] = &slot.msg; })) == 0) {
+            if (!grow()) {
+                return 0;
+            }
+        }
+        return count;
+    }
+    // Links the batch through the slot headers and pushes it with a single CAS
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        if (msgs.empty()) return;
+        for (size_t i = 1; i < msgs.size(); ++i) {
+            slotOf(msgs[i - 1]).next.store(slotOf(msgs[i]).index, std::memory_order_relaxed);
+        }
+        pushChain(slotOf(msgs.front()).index, slotOf(msgs.back()).index);
+    }
+
+    size_t slabs() const { return slabCount_.load(std::memory_order_relaxed); }    // mapped, spares included
+    size_t capacity() const { return slabs() * SlabSize; }
+    uint64_t coldGrowths() const { return coldGrowths_.load(std::memory_order_relaxed); } // slabs mapped on the hot path
 private:
-    std::vector<Msg> pool_;
-    std::vector<size_t> nextFree_;
-    std::atomic<size_t> head_; // lower 32 bits: index, upper 32 bits: tag
+    struct Slot {
+        Msg msg;                            // first, so a MsgPtr is also the Slot address
+        uint32_t index = 0;
+        std::atomic<uint32_t> next{ 0 };
+    };
+    static_assert(std::is_standard_layout_v<Slot>, "SegmentedPool needs a standard-layout Msg");
+
+    struct Chain {
+        size_t first;
+        size_t last;
+    };
 
     static constexpr size_t INDEX_MASK = 0xFFFFFFFF;
+    static constexpr size_t EMPTY_INDEX = INDEX_MASK;
     static constexpr size_t TAG_SHIFT = 32;
 
-    inline size_t pack(size_t index, uint32_t tag) {
-        return (static_cast<size_t>(tag) << TAG_SHIFT) | (static_cast<uint32_t>(index));
+    static inline size_t pack(size_t index, uint32_t tag) {
+        return (static_cast<size_t>(tag) << TAG_SHIFT) | static_cast<uint32_t>(index);
+    }
+    static inline Slot& slotOf(MsgPtr msg) {
+        return *reinterpret_cast<Slot*>(msg);
+    }
+    inline Slot& slotAt(size_t index) {
+        return directory_[index / SlabSize].load(std::memory_order_acquire)[index % SlabSize];
     }
 
-    inline void unpack(size_t packed, size_t &index, uint32_t &tag) {
-        index = static_cast<size_t>(packed & INDEX_MASK);
-        tag = static_cast<uint32_t>(packed >> TAG_SHIFT);
+    // Maps and prefaults slab n and links its slots into a chain, which is not yet on the free list
+    Chain mapSlab(size_t n) {
+        auto slab = std::make_unique<HugePageBuffer<Slot>>(SlabSize, options_);
+        const size_t base = n * SlabSize;
+        for (size_t i = 0; i < SlabSize; ++i) {
+            (*slab)[i].index = static_cast<uint32_t>(base + i);
+            (*slab)[i].next.store(static_cast<uint32_t>(base + i + 1), std::memory_order_relaxed);
+        }
+        directory_[n].store(slab->data(), std::memory_order_release);
+        slabs_[n] = std::move(slab);
+        return { base, base + SlabSize - 1 };
+    }
+
+    // Puts a spare slab, or failing that a freshly mapped one, on the free list. Cold path.
+    bool grow() {
+        std::unique_lock<std::mutex> lock(growMutex_);
+        if ((head_.load(std::memory_order_acquire) & INDEX_MASK) != EMPTY_INDEX) {
+            return true;    // another thread got here first
+        }
+        Chain chain;
+        if (!spare_.empty()) {
+            chain = spare_.front();
+            spare_.pop_front();
+        }
+        else {
+            if (slabCount_.load(std::memory_order_relaxed) == MaxSlabs) {
+                return false;
+            }
+            chain = mapSlab(slabCount_.fetch_add(1, std::memory_order_relaxed));
+            coldGrowths_.fetch_add(1, std::memory_order_relaxed);
+        }
+        pushChain(chain.first, chain.last);
+        lock.unlock();
+        growCv_.notify_one();
+        return true;
+    }
+
+    // Background thread, tops the spare slabs back up to headroomSlabs_ without holding the lock while mapping
+    void growLoop() {
+        std::unique_lock<std::mutex> lock(growMutex_);
+        while (!stopGrowing_) {
+            if (spare_.size() < headroomSlabs_ && slabCount_.load(std::memory_order_relaxed) < MaxSlabs) {
+                const size_t n = slabCount_.fetch_add(1, std::memory_order_relaxed);
+                lock.unlock();
+                const Chain chain = mapSlab(n);
+                lock.lock();
+                spare_.push_back(chain);
+                continue;
+            }
+            growCv_.wait(lock);
+        }
+    }
+
+    // Same as LockFreeThreadSafePool::popChain, slots are looked up through the slab directory
+    template <typename Store>
+    size_t popChain(size_t count, Store&& store) {
+        size_t oldHead = head_.load(std::memory_order_acquire);
+        while (true) {
+            size_t index = oldHead & INDEX_MASK;
+            const uint32_t tag = static_cast<uint32_t>(oldHead >> TAG_SHIFT);
+            size_t taken = 0;
+            while (index != EMPTY_INDEX && taken < count) {
+                Slot& slot = slotAt(index);
+                store(taken++, slot);
+                index = slot.next.load(std::memory_order_relaxed);
+            }
+            if (taken == 0) {
+                return 0;
+            }
+            if (head_.compare_exchange_weak(oldHead, pack(index, tag + 1),
+                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return taken;
+            }
+        }
     }
+
+    // Pushes an already linked chain first..last onto the free list with one CAS
+    void pushChain(size_t first, size_t last) {
+        Slot& lastSlot = slotAt(last);
+        size_t oldHead = head_.load(std::memory_order_acquire);
+        while (true) {
+            lastSlot.next.store(static_cast<uint32_t>(oldHead & INDEX_MASK), std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(oldHead, pack(first, static_cast<uint32_t>(oldHead >> TAG_SHIFT) + 1),
+                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return;
+            }
+        }
+    }
+
+    alignas(64) std::atomic<size_t> head_{ pack(EMPTY_INDEX, 0) }; // lower 32 bits: index, upper 32 bits: tag
+    alignas(64) std::atomic<Slot*> directory_[MaxSlabs] = {};
+    std::unique_ptr<HugePageBuffer<Slot>> slabs_[MaxSlabs];         // owns the slabs, written once per slab
+    std::atomic<size_t> slabCount_{ 0 };
+    std::atomic<uint64_t> coldGrowths_{ 0 };
+    const size_t headroomSlabs_;
+    const PageOptions options_;
+    std::mutex growMutex_;
+    std::condition_variable growCv_;
+    std::deque<Chain> spare_;   // guarded by growMutex_
+    bool stopGrowing_ = false;  // guarded by growMutex_
+    std::thread growThread_;
 };
 
 #ifdef USE_FOLLY_MEM_POOL
@@ -264,6 +777,18 @@ public:
         pool_.snapshot().lease_all();
         pool_.give_back(msg);
     }
+    size_t allocate_bulk(size_t n, MsgPtr* out) {
+        size_t count = 0;
+        while (count < n && (out[count] = allocate()) != nullptr) {
+            ++count;
+        }
+        return count;
+    }
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        for (MsgPtr msg : msgs) {
+            deallocate(msg);
+        }
+    }
 private:
     folly::IndexedMemPool<Msg> pool_;
 };
@@ -13,6 +13,10 @@
 #include <iomanip>
 #include <ranges>
 #include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <map>
 
 #define COLOR_RED     "\033[31m"
 #define COLOR_GREEN   "\033[32m"
@@ -22,7 +26,11 @@
 namespace Const {
     constexpr size_t PoolSize = 10'000'000; 
     constexpr size_t NumOrders = 1'000'000; 
-    constexpr size_t MaxPriceLevels = 100'000; 
+#ifndef LADDER_LEVELS
+    constexpr size_t LadderLevels = 1 << 14;    // Price levels kept in arrays around mid, per side
+#else
+    constexpr size_t LadderLevels = LADDER_LEVELS;
+#endif
     constexpr double TickSize = 0.01; 
     constexpr size_t TicksPerUnit = static_cast<size_t>(1 / TickSize);
 }
@@ -34,16 +42,107 @@ struct alignas(64) Order {
     bool is_buy;
 };
 
-template <bool RequireStorage>
+/**************************************************************************
+Occupancy of Levels price levels as a three-level 64-ary bitmap. Bit i of
+words_ is set while level i holds quantity, bit w of summary_ while word w of
+words_ is non-zero, and bit j of top_ while word j of summary_ is non-zero.
+next() and prev() find the nearest occupied level with at most one countr_zero
+or countl_zero (tzcnt/lzcnt) per level of the bitmap, however far it is.
+Levels up to 64^3 = 262,144 are supported.
+**************************************************************************/
+template <size_t Levels>
+class LevelBitmap {
+public:
+    static constexpr int None = -1;
+
+    inline void set(size_t level) {
+        const size_t word = level >> 6;
+        words_[word] |= bit(level);
+        summary_[word >> 6] |= bit(word);
+        top_ |= bit(word >> 6);
+    }
+    inline void clear(size_t level) {
+        const size_t word = level >> 6;
+        words_[word] &= ~bit(level);
+        if (words_[word] == 0) {
+            summary_[word >> 6] &= ~bit(word);
+            if (summary_[word >> 6] == 0) {
+                top_ &= ~bit(word >> 6);
+            }
+        }
+    }
+    // Lowest occupied level >= level, None if there is none
+    inline int next(size_t level) const {
+        if (level >= Levels) return None;
+        size_t word = level >> 6;
+        uint64_t bits = words_[word] & (~0ull << (level & 63));
+        if (bits != 0) return static_cast<int>((word << 6) + std::countr_zero(bits));
+        if (++word >= Words) return None;
+        size_t group = word >> 6;
+        bits = summary_[group] & (~0ull << (word & 63));
+        if (bits == 0) {
+            if (++group >= Groups) return None;
+            bits = top_ & (~0ull << group);
+            if (bits == 0) return None;
+            group = std::countr_zero(bits);
+            bits = summary_[group];
+        }
+        word = (group << 6) + std::countr_zero(bits);
+        return static_cast<int>((word << 6) + std::countr_zero(words_[word]));
+    }
+    // Highest occupied level <= level, None if there is none
+    inline int prev(size_t level) const {
+        if (level >= Levels) level = Levels - 1;
+        size_t word = level >> 6;
+        uint64_t bits = words_[word] & (~0ull >> (63 - (level & 63)));
+        if (bits != 0) return static_cast<int>((word << 6) + 63 - std::countl_zero(bits));
+        if (word-- == 0) return None;
+        size_t group = word >> 6;
+        bits = summary_[group] & (~0ull >> (63 - (word & 63)));
+        if (bits == 0) {
+            if (group-- == 0) return None;
+            bits = top_ & (~0ull >> (63 - group));
+            if (bits == 0) return None;
+            group = 63 - std::countl_zero(bits);
+            bits = summary_[group];
+        }
+        word = (group << 6) + 63 - std::countl_zero(bits);
+        return static_cast<int>((word << 6) + 63 - std::countl_zero(words_[word]));
+    }
+private:
+    static constexpr size_t Words = (Levels + 63) / 64;
+    static constexpr size_t Groups = (Words + 63) / 64;
+    static_assert(Groups <= 64, "LevelBitmap supports up to 64^3 levels");
+
+    static constexpr uint64_t bit(size_t index) { return 1ull << (index & 63); }
+
+    std::array<uint64_t, Words> words_{};
+    std::array<uint64_t, Groups> summary_{};
+    uint64_t top_ = 0;
+};
+
+/**************************************************************************
+Prices are int64 tick counts (llround(price / TickSize)), so any instrument
+price is representable. Each side keeps Const::LadderLevels levels in a flat
+array covering [base_, base_ + LadderLevels) ticks, indexed by an occupancy
+LevelBitmap. Levels outside the window live in a std::map per side.
+Once a best level leaves the window, recenter() centers the window on mid
+again. It visits only occupied levels, found through the bitmaps and the
+maps' ordered ranges, so the hot levels near the top of the book stay in a
+small, cache-resident array.
+OrderMap is any MyHM map template, keyed by order id.
+**************************************************************************/
+template <bool RequireStorage, template <typename, typename> class OrderMap = RobinHoodHashMap>
 class OrderBook {
 public:
     using OrderPtr = Order*;
-    OrderBook() 
-            : bestBidIndex_(-1)
-            , bestAskIndex_(Const::MaxPriceLevels) {
+    // orderBuckets sizes the order map, maxOrders the order pool when RequireStorage is true
+    explicit OrderBook(size_t orderBuckets = Const::initBuckets, size_t maxOrders = Const::PoolSize) 
+            : orderMap_(orderBuckets) {
         
         if constexpr (RequireStorage) {
-            freeMsgPtrs_.reserve(Const::PoolSize); // reserve space for Const::PoolSize orders
+            orderPool_.resize(maxOrders);
+            freeMsgPtrs_.reserve(maxOrders);
             for (auto& order : orderPool_) {
                 freeMsgPtrs_.emplace_back(&order);
             }
@@ -52,7 +151,7 @@ public:
     void insert(OrderPtr order) {
         OrderPtr mem = nullptr;
         if constexpr (RequireStorage) {
-            if (orderCount_ >= Const::PoolSize) {
+            if (orderCount_ >= orderPool_.size()) {
                 throw std::runtime_error("Order pool is full");
             }
             ++orderCount_;
@@ -70,24 +169,20 @@ public:
         orderMap_[order->order_id] = mem;
 
         // Update price levels
-        int idx = priceToIndex(order->price);
         if (order->is_buy) {
-            bidLevels_[idx] += order->quantity;
-            if (idx > bestBidIndex_) 
-                bestBidIndex_ = idx;
+            updatePriceLevel<true>(order->price, order->quantity);
         } 
         else {
-            askLevels_[idx] += order->quantity;
-            if (idx < bestAskIndex_) 
-                bestAskIndex_ = idx;
+            updatePriceLevel<false>(order->price, order->quantity);
         }
     }
     
     void update(uint64_t order_id, int new_quantity) {
-        if (!orderMap_.contains(order_id)) {
+        OrderPtr* found = orderMap_.find(order_id);
+        if (found == nullptr) {
             throw std::runtime_error("Order not found");
         }
-        OrderPtr ord = orderMap_[order_id];
+        OrderPtr ord = *found;
 
         if (ord->is_buy) {
             updatePriceLevel<true>(ord->price, (new_quantity - ord->quantity));
@@ -99,10 +194,11 @@ public:
     }
     
     void cancel(uint64_t order_id) {
-        if (!orderMap_.contains(order_id)) {
+        OrderPtr* found = orderMap_.find(order_id);
+        if (found == nullptr) {
             throw std::runtime_error("Order not found");
         }
-        OrderPtr ord = orderMap_[order_id];
+        OrderPtr ord = *found;
         if (ord->is_buy) {
             updatePriceLevel<true>(ord->price, -ord->quantity);
         } 
@@ -110,36 +206,32 @@ public:
             updatePriceLevel<false>(ord->price, -ord->quantity);
         }
         if constexpr (RequireStorage) {
-            freeMsgPtrs_.emplace_back(orderMap_[order_id]);
+            freeMsgPtrs_.emplace_back(ord);
             --orderCount_;
         }
         orderMap_.erase(order_id); 
     }
     
+    // { 0.0, 0 } while the side has no orders
     std::pair<double, int> bestBid() const {
-        double bestBidPrice = indexToPrice(bestBidIndex_);
-        return { bestBidPrice, bidLevels_[bestBidIndex_] };
+        const int64_t ticks = bestTicks<true>();
+        if (ticks == NoBid) 
+            return { 0.0, 0 };
+        return { ticksToPrice(ticks), levelQuantity<true>(ticks) };
     }
     std::pair<double, int> bestAsk() const {
-        double bestAskPrice = indexToPrice(bestAskIndex_);
-        return { bestAskPrice, askLevels_[bestAskIndex_] };
+        const int64_t ticks = bestTicks<false>();
+        if (ticks == NoAsk) 
+            return { 0.0, 0 };
+        return { ticksToPrice(ticks), levelQuantity<false>(ticks) };
     }
 
     void print(std::ostream& stream, const std::string& title, size_t count = 10) const {
         stream << "----- Order Book [" << title << "] (Top " << count << " levels) -----\n";
 
-        std::vector<std::pair<double, int>> asks, bids;
-        asks.reserve(count);
-        bids.reserve(count);
-        for (int i = bestAskIndex_; i < Const::MaxPriceLevels && asks.size() < count; ++i) {
-            if (askLevels_[i] > 0) 
-                asks.emplace_back(indexToPrice(i), askLevels_[i]);
-        }
+        std::vector<std::pair<double, int>> asks = topLevels<false>(count);
+        std::vector<std::pair<double, int>> bids = topLevels<true>(count);
         std::ranges::reverse(asks);
-        for (int i = bestBidIndex_; i >= 0 && bids.size() < count; --i) {
-            if (bidLevels_[i] > 0)
-                bids.emplace_back(indexToPrice(i), bidLevels_[i]);
-        }
         
         auto printVector = [&](std::vector<std::pair<double, int>>& vec) {
             for (auto& [price, quantity] : vec) {
@@ -148,8 +240,13 @@ public:
             }
         };
 
-        // TODO : If one side has no orders, midPrice is wrong!!!
-        double midPrice = (indexToPrice(bestAskIndex_) + indexToPrice(bestBidIndex_)) / 2.0;
+        // With one side empty the other side's best stands in for mid
+        const int64_t bid = bestTicks<true>(), ask = bestTicks<false>();
+        double midPrice = 0.0;
+        if (bid != NoBid && ask != NoAsk) 
+            midPrice = (ticksToPrice(bid) + ticksToPrice(ask)) / 2.0;
+        else if (bid != NoBid || ask != NoAsk) 
+            midPrice = ticksToPrice(bid != NoBid ? bid : ask);
         stream << "   Quantity |   Price\n";
         stream << "------------------------\n";
         stream << COLOR_RED;
@@ -161,50 +258,170 @@ public:
         stream << COLOR_RESET;
     }
 private:
-    inline int priceToIndex(double price) const {
-        return static_cast<int>(price * Const::TicksPerUnit);
+    using Bitmap = LevelBitmap<Const::LadderLevels>;
+    static constexpr int64_t Window = static_cast<int64_t>(Const::LadderLevels);
+    static constexpr int64_t NoBid = std::numeric_limits<int64_t>::min();
+    static constexpr int64_t NoAsk = std::numeric_limits<int64_t>::max();
+
+    // One side of the book: the window's levels, their bitmap, the window's best and the overflow
+    struct Side {
+        explicit Side(int emptyBest) : best(emptyBest) { }
+        std::array<int, Const::LadderLevels> levels{};
+        Bitmap bits;
+        int best;                               // window index, -1 (bids) or Window (asks) if none
+        std::map<int64_t, int> overflow;        // ticks -> quantity of levels outside the window
+    };
+
+    static inline int64_t priceToTicks(double price) {
+        return std::llround(price * Const::TicksPerUnit);
+    }
+    static inline double ticksToPrice(int64_t ticks) {
+        return ticks * Const::TickSize;
+    }
+    inline bool inWindow(int64_t ticks) const {
+        return ticks >= base_ && ticks < base_ + Window;
+    }
+
+    // Best price in ticks over the window and the overflow, NoBid / NoAsk if the side is empty
+    template <bool IS_BUY>
+    int64_t bestTicks() const {
+        if constexpr (IS_BUY) {
+            int64_t best = (bids_.best >= 0) ? base_ + bids_.best : NoBid;
+            if (!bids_.overflow.empty()) 
+                best = std::max(best, bids_.overflow.rbegin()->first);
+            return best;
+        }
+        else {
+            int64_t best = (asks_.best < Window) ? base_ + asks_.best : NoAsk;
+            if (!asks_.overflow.empty()) 
+                best = std::min(best, asks_.overflow.begin()->first);
+            return best;
+        }
     }
-    inline double indexToPrice(int index) const {
-        return index * Const::TickSize;
+    template <bool IS_BUY>
+    int levelQuantity(int64_t ticks) const {
+        const Side& side = IS_BUY ? bids_ : asks_;
+        if (inWindow(ticks)) 
+            return side.levels[ticks - base_];
+        auto it = side.overflow.find(ticks);
+        return (it != side.overflow.end()) ? it->second : 0;
     }
 
     template <bool IS_BUY>
     void updatePriceLevel(double price, int updateQuantity) {
-        const int idx = priceToIndex(price);
+        const int64_t ticks = priceToTicks(price);
+        Side& side = IS_BUY ? bids_ : asks_;
+        if (!inWindow(ticks)) {
+            auto it = side.overflow.try_emplace(ticks, 0).first;
+            it->second += updateQuantity;
+            if (it->second == 0) 
+                side.overflow.erase(it);
+        }
+        else {
+            const int idx = static_cast<int>(ticks - base_);
+            side.levels[idx] += updateQuantity;
+            if (side.levels[idx] != 0) {
+                side.bits.set(idx);
+                if (IS_BUY ? idx > side.best : idx < side.best) 
+                    side.best = idx;
+            }
+            else {
+                side.bits.clear(idx);
+                if (idx == side.best) 
+                    side.best = windowBest<IS_BUY>(side);
+            }
+        }
+        recenterIfDrifted();
+    }
+    template <bool IS_BUY>
+    static int windowBest(const Side& side) {
         if constexpr (IS_BUY) {
-            bidLevels_[idx] += updateQuantity;
-            if (idx == bestBidIndex_ && bidLevels_[idx] == 0) {
-                for (int i = idx - 1; i >= 0; --i) {
-                    if (bidLevels_[i] > 0) {
-                        bestBidIndex_ = i;
-                        return;
-                    }
-                }  
-                bestBidIndex_ = 0;    
-            }   
-        } 
+            return side.bits.prev(Const::LadderLevels - 1);
+        }
+        else {
+            const int next = side.bits.next(0);
+            return (next == Bitmap::None) ? static_cast<int>(Window) : next;
+        }
+    }
+
+    // Centers the window on mid once a best level has left it. A spread too wide for both
+    // bests to fit leaves the window where it is, else every op would move it.
+    void recenterIfDrifted() {
+        const int64_t bid = bestTicks<true>(), ask = bestTicks<false>();
+        if ((bid == NoBid || inWindow(bid)) && (ask == NoAsk || inWindow(ask))) 
+            return;
+        if (bid != NoBid && ask != NoAsk) {
+            if (std::abs(ask - bid) < Window / 2) 
+                recenter(bid + (ask - bid) / 2 - Window / 2);
+        }
+        else {
+            recenter((bid != NoBid ? bid : ask) - Window / 2);
+        }
+    }
+    void recenter(int64_t newBase) {
+        rebase<true>(bids_, newBase);
+        rebase<false>(asks_, newBase);
+        base_ = newBase;
+    }
+    // Moves a side's occupied levels to a window starting at newBase: window levels that
+    // still fit shift, the rest go to the overflow, and overflow levels that now fit come in
+    template <bool IS_BUY>
+    void rebase(Side& side, int64_t newBase) {
+        scratch_.clear();
+        for (int i = side.bits.next(0); i != Bitmap::None; i = side.bits.next(i + 1)) {
+            const int64_t ticks = base_ + i;
+            if (ticks >= newBase && ticks < newBase + Window) 
+                scratch_.emplace_back(ticks, side.levels[i]);
+            else 
+                side.overflow.emplace(ticks, side.levels[i]);
+            side.levels[i] = 0;
+            side.bits.clear(i);
+        }
+        auto first = side.overflow.lower_bound(newBase);
+        auto last = side.overflow.lower_bound(newBase + Window);
+        scratch_.insert(scratch_.end(), first, last);
+        side.overflow.erase(first, last);
+        for (const auto& [ticks, quantity] : scratch_) {
+            const int idx = static_cast<int>(ticks - newBase);
+            side.levels[idx] = quantity;
+            side.bits.set(idx);
+        }
+        side.best = windowBest<IS_BUY>(side);
+    }
+
+    // Up to count levels, best first, over the window and the overflow
+    template <bool IS_BUY>
+    std::vector<std::pair<double, int>> topLevels(size_t count) const {
+        const Side& side = IS_BUY ? bids_ : asks_;
+        std::vector<std::pair<int64_t, int>> levels;
+        if constexpr (IS_BUY) {
+            for (int i = side.best; i >= 0 && levels.size() < count; i = (i > 0) ? side.bits.prev(i - 1) : -1) 
+                levels.emplace_back(base_ + i, side.levels[i]);
+            for (auto it = side.overflow.rbegin(); it != side.overflow.rend() && levels.size() < 2 * count; ++it) 
+                levels.emplace_back(*it);
+            std::ranges::sort(levels, std::ranges::greater{}, [](const auto& level) { return level.first; });
+        }
         else {
-            askLevels_[idx] += updateQuantity;
-            if (idx == bestAskIndex_ && askLevels_[idx] == 0) {
-                for (int i = idx + 1; i < Const::MaxPriceLevels; ++i) {
-                    if (askLevels_[i] > 0) {
-                        bestAskIndex_ = i;
-                        return;
-                    }
-                }
-                bestAskIndex_ = Const::MaxPriceLevels - 1;
-            }    
+            for (int i = side.bits.next(0); i >= 0 && levels.size() < count; i = side.bits.next(i + 1)) 
+                levels.emplace_back(base_ + i, side.levels[i]);
+            for (auto it = side.overflow.begin(); it != side.overflow.end() && levels.size() < 2 * count; ++it) 
+                levels.emplace_back(*it);
+            std::ranges::sort(levels, std::ranges::less{}, [](const auto& level) { return level.first; });
         }
+        std::vector<std::pair<double, int>> out;
+        for (size_t i = 0; i < levels.size() && i < count; ++i) 
+            out.emplace_back(ticksToPrice(levels[i].first), levels[i].second);
+        return out;
     }
 
     std::vector<Order> orderPool_;              // used only if RequireStorage is true
     std::vector<OrderPtr> freeMsgPtrs_;         // used only if RequireStorage is true
     size_t orderCount_ = 0;                     // used only if RequireStorage is true  
-    HashMap<FixedSizedChainingHashMap<uint64_t, OrderPtr>> orderMap_; // order_id -> pointer to Order
-    std::array<int, Const::MaxPriceLevels> bidLevels_{};
-    std::array<int, Const::MaxPriceLevels> askLevels_{};
-    int bestBidIndex_;
-    int bestAskIndex_;
+    HashMap<OrderMap<uint64_t, OrderPtr>> orderMap_; // order_id -> pointer to Order
+    int64_t base_ = 0;                          // ticks of window index 0, moved by recenter()
+    Side bids_{ -1 };
+    Side asks_{ static_cast<int>(Window) };
+    std::vector<std::pair<int64_t, int>> scratch_;  // levels being moved by rebase()
 };
 
-// HashMap types : ChainingHashMap, FixedSizedChainingHashMap, OpenAddressingHashMap, STLHashMap
\ No newline at end of file
+// HashMap types : ChainingHashMap, FixedSizedChainingHashMap, OpenAddressingHashMap, SwissHashMap, RobinHoodHashMap, STLHashMap
\ No newline at end of file
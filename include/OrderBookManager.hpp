@@ -0,0 +1,263 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <pthread.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "OrderBook.hpp"
+#include "ByteRingBuffer.hpp"
+#include "SymbolTable.hpp"
+#include "WaitStrategy.hpp"
+
+namespace Const {
+#ifndef BOOK_ORDER_BUCKETS
+    constexpr size_t bookOrderBuckets = 1 << 14;    // Initial order map buckets of each managed book
+#else
+    constexpr size_t bookOrderBuckets = BOOK_ORDER_BUCKETS;
+#endif
+#ifndef BOOK_MAX_ORDERS
+    constexpr size_t bookMaxOrders = 1 << 14;       // Resting orders each managed book can hold
+#else
+    constexpr size_t bookMaxOrders = BOOK_MAX_ORDERS;
+#endif
+#ifndef SHARD_RING_BYTES
+    constexpr size_t shardRingBytes = 1 << 20;      // 1MB - Command ring of each shard
+#else
+    constexpr size_t shardRingBytes = SHARD_RING_BYTES;
+#endif
+    constexpr size_t shardConsumeBatch = 64;        // Commands a worker applies per ring release
+};
+
+enum class BookCommandType : uint16_t { Insert, Update, Cancel };
+
+// Payload of one shard ring record, the command type travels in the record header
+struct BookCommand {
+    uint64_t order_id;
+    double price;           // Insert only
+    SymbolId symbol;
+    int quantity;           // Insert and Update
+    bool is_buy;            // Insert only
+};
+
+struct TopOfBook {
+    double bidPrice;
+    int bidQuantity;
+    double askPrice;
+    int askQuantity;
+    bool operator==(const TopOfBook&) const = default;
+};
+
+/**************************************************************************
+One OrderBook per symbol, sharded over worker threads by symbol id. Each shard
+has an SPSC ByteRingBuffer of BookCommand records written by the single feed
+thread, and a worker that owns the shard's books outright, so books need no
+locks. A worker creates a book on its first command for that symbol, which also
+places the book's memory on the worker's NUMA node.
+After every command that moves a best level, the worker publishes the book's
+top of book to a per-symbol slot guarded by a seqlock. topOfBook() can then
+be read from any thread without locks, and never delays the worker.
+Commands for unknown orders or full books are counted as rejected rather than
+stopping the shard. Check TestOrderBookManager.cpp for usage examples.
+**************************************************************************/
+template <template <typename, typename> class OrderMap = RobinHoodHashMap, typename Wait = YieldWait>
+class OrderBookManager {
+public:
+    using Book = OrderBook<true, OrderMap>;
+
+    OrderBookManager(size_t shards, size_t maxSymbols = Const::symbolTableCapacity,
+                     size_t ringBytes = Const::shardRingBytes)
+            : tops_(std::make_unique<TopSlot[]>(maxSymbols))
+            , maxSymbols_(maxSymbols) {
+        if (shards == 0) {
+            throw std::runtime_error("OrderBookManager needs at least one shard");
+        }
+        for (size_t i = 0; i < shards; ++i) {
+            shards_.emplace_back(std::make_unique<Shard>(ringBytes));
+        }
+        std::cout << "OrderBookManager initialized with " << shards << " shards" << std::endl;
+    }
+    OrderBookManager(OrderBookManager const&) = delete;
+    OrderBookManager& operator=(OrderBookManager const&) = delete;
+    ~OrderBookManager() { stop(); }
+
+    // Starts one worker per shard, pinned to firstCpu + shard unless firstCpu is negative
+    void start(int firstCpu = -1) {
+        runFlag_.store(true, std::memory_order_relaxed);
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            shards_[i]->worker = std::thread([this, i, firstCpu] {
+                if (firstCpu >= 0) {
+                    pinToCpu(firstCpu + static_cast<int>(i));
+                }
+                runShard(*shards_[i]);
+            });
+        }
+    }
+    // Applies every command already enqueued, then joins the workers
+    void stop() {
+        runFlag_.store(false, std::memory_order_release);
+        for (auto& shard : shards_) {
+            if (shard->worker.joinable()) {
+                shard->worker.join();
+            }
+        }
+    }
+
+    // Producer side, called by one feed thread. False when the shard's ring is full.
+    bool insert(SymbolId symbol, const Order& order) {
+        return send(BookCommandType::Insert,
+                    BookCommand{ order.order_id, order.price, symbol, order.quantity, order.is_buy });
+    }
+    bool update(SymbolId symbol, uint64_t order_id, int quantity) {
+        return send(BookCommandType::Update, BookCommand{ order_id, 0.0, symbol, quantity, false });
+    }
+    bool cancel(SymbolId symbol, uint64_t order_id) {
+        return send(BookCommandType::Cancel, BookCommand{ order_id, 0.0, symbol, 0, false });
+    }
+
+    // Latest top of book published for symbol, from any thread
+    TopOfBook topOfBook(SymbolId symbol) const {
+        checkSymbol(symbol);
+        const TopSlot& slot = tops_[symbol];
+        while (true) {
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                cpuRelax();
+                continue;
+            }
+            const TopOfBook top = slot.top;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                return top;
+            }
+        }
+    }
+
+    size_t shardOf(SymbolId symbol) const { return symbol % shards_.size(); }
+    size_t shards() const { return shards_.size(); }
+    // Commands applied and rejected so far over every shard
+    uint64_t processed() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards_) total += shard->processed.load(std::memory_order_relaxed);
+        return total;
+    }
+    uint64_t rejected() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards_) total += shard->rejected.load(std::memory_order_relaxed);
+        return total;
+    }
+private:
+    struct alignas(64) TopSlot {
+        std::atomic<uint32_t> seq{ 0 };     // odd while the worker writes top
+        TopOfBook top{};
+    };
+    struct Shard {
+        explicit Shard(size_t ringBytes) : ring(ringBytes) { }
+        SPSCByteRingBuffer ring;
+        std::vector<std::unique_ptr<Book>> books;   // indexed by symbol / shard count
+        std::thread worker;
+        Wait wait;
+        alignas(64) std::atomic<uint64_t> processed{ 0 };
+        std::atomic<uint64_t> rejected{ 0 };
+    };
+
+    void checkSymbol(SymbolId symbol) const {
+        if (symbol >= maxSymbols_) [[unlikely]] {
+            throw std::runtime_error("Symbol id beyond OrderBookManager maxSymbols");
+        }
+    }
+
+    bool send(BookCommandType type, const BookCommand& command) {
+        checkSymbol(command.symbol);
+        SPSCByteRingBuffer& ring = shards_[shardOf(command.symbol)]->ring;
+        const auto reservation = ring.reserve(sizeof(BookCommand));
+        if (reservation.data == nullptr) {
+            return false;
+        }
+        std::memcpy(reservation.data, &command, sizeof(BookCommand));
+        ring.commit(reservation, static_cast<uint16_t>(type), sizeof(BookCommand));
+        return true;
+    }
+
+    void runShard(Shard& shard) {
+        auto apply = [this, &shard](uint16_t type, const char* payload, size_t) {
+            BookCommand command;
+            std::memcpy(&command, payload, sizeof(BookCommand));
+            applyCommand(shard, static_cast<BookCommandType>(type), command);
+        };
+        while (true) {
+            if (shard.ring.consume(apply, Const::shardConsumeBatch) > 0) {
+                shard.wait.reset();
+                continue;
+            }
+            if (!runFlag_.load(std::memory_order_acquire)) {
+                while (shard.ring.consume(apply, Const::shardConsumeBatch) > 0) { }   // enqueued before stop()
+                break;
+            }
+            shard.wait.idle(shard.ring);
+        }
+    }
+
+    void applyCommand(Shard& shard, BookCommandType type, const BookCommand& command) {
+        const size_t local = command.symbol / shards_.size();
+        if (local >= shard.books.size()) {
+            shard.books.resize(local + 1);
+        }
+        if (!shard.books[local]) {
+            shard.books[local] = std::make_unique<Book>(Const::bookOrderBuckets, Const::bookMaxOrders);
+        }
+        Book& book = *shard.books[local];
+        try {
+            switch (type) {
+            case BookCommandType::Insert: {
+                Order order{ command.order_id, command.price, command.quantity, command.is_buy };
+                book.insert(&order);
+                break;
+            }
+            case BookCommandType::Update:
+                book.update(command.order_id, command.quantity);
+                break;
+            case BookCommandType::Cancel:
+                book.cancel(command.order_id);
+                break;
+            }
+        }
+        catch (const std::runtime_error&) {
+            shard.rejected.store(shard.rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        publishTop(command.symbol, book);
+        shard.processed.store(shard.processed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Only the owning worker writes a symbol's slot, so the sequence needs no CAS
+    void publishTop(SymbolId symbol, const Book& book) {
+        const auto [bidPrice, bidQuantity] = book.bestBid();
+        const auto [askPrice, askQuantity] = book.bestAsk();
+        const TopOfBook top{ bidPrice, bidQuantity, askPrice, askQuantity };
+        TopSlot& slot = tops_[symbol];
+        if (slot.top == top) {
+            return;
+        }
+        const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);     // top stores stay behind the odd sequence
+        slot.top = top;
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    static void pinToCpu(int cpu) {
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu % cores, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::unique_ptr<TopSlot[]> tops_;
+    size_t maxSymbols_;
+    alignas(64) std::atomic<bool> runFlag_{ false };
+};
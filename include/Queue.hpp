@@ -1,13 +1,18 @@
 #pragma once
 
 #include <vector>
+#include <span>
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <concepts>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
+#include <stdexcept>
 #include <boost/lockfree/queue.hpp>
+#include "HugePages.hpp"
 
 // #define USE_MOODYCAMEL_QUEUE
 
@@ -17,31 +22,89 @@ namespace Const {
 #else
     constexpr size_t queueCapacity = QUEUE_CAPACITY; // Use user-defined capacity
 #endif
+#ifndef QUEUE_BULK_SIZE
+    constexpr size_t queueBulkSize = 64; // Default max messages drained per bulk dequeue
+#else
+    constexpr size_t queueBulkSize = QUEUE_BULK_SIZE; // Use user-defined bulk size
+#endif
 };
 
 template <typename T>
 concept MsgPtr = std::is_pointer_v<T>;
 
+// Snapshot of a queue's counters, all maintained with relaxed atomics off the critical path
+struct QueueStats {
+    uint64_t enqueued = 0;      // messages accepted
+    uint64_t dequeued = 0;      // messages handed to consumers
+    uint64_t rejected = 0;      // messages dropped by producers because the queue was full, see reject()
+    uint64_t highWater = 0;     // highest occupancy observed
+    uint64_t size() const { return enqueued - dequeued; }
+};
+
+// Occupancy is tail - head from one producer's view; another thread may already have moved head past it
+inline void updateHighWater(std::atomic<size_t>& highWater, size_t tail, size_t head) {
+    if (head >= tail) return;
+    const size_t occupancy = tail - head;
+    size_t current = highWater.load(std::memory_order_relaxed);
+    while (occupancy > current && 
+            !highWater.compare_exchange_weak(current, occupancy, std::memory_order_relaxed)) { }
+}
+
+// Counters for wrapped third-party queues that do not expose their indices
+class QueueCounters {
+public:
+    inline void onEnqueue(size_t count) {
+        const size_t enqueued = enqueued_.fetch_add(count, std::memory_order_relaxed) + count;
+        updateHighWater(highWater_, enqueued, dequeued_.load(std::memory_order_relaxed));
+    }
+    inline void onDequeue(size_t count) { dequeued_.fetch_add(count, std::memory_order_relaxed); }
+    inline void onReject(size_t count) { rejected_.fetch_add(count, std::memory_order_relaxed); }
+    inline QueueStats snapshot() const {
+        QueueStats stats;
+        stats.dequeued = dequeued_.load(std::memory_order_relaxed);
+        stats.enqueued = std::max<uint64_t>(enqueued_.load(std::memory_order_relaxed), stats.dequeued);
+        stats.rejected = rejected_.load(std::memory_order_relaxed);
+        stats.highWater = highWater_.load(std::memory_order_relaxed);
+        return stats;
+    }
+private:
+    alignas(64) std::atomic<size_t> enqueued_{ 0 };
+    std::atomic<size_t> rejected_{ 0 };
+    std::atomic<size_t> highWater_{ 0 };
+    alignas(64) std::atomic<size_t> dequeued_{ 0 };
+};
+
 template <typename Q>
-concept MyQ = requires(Q q, typename Q::value_type ptr) {
+concept MyQ = requires(Q q, typename Q::value_type ptr, std::span<typename Q::value_type> ptrs) {
     { q.enqueue(ptr) } -> std::convertible_to<bool>;
     { q.dequeue() } -> std::convertible_to<typename Q::value_type>;
+    { q.enqueue_bulk(ptrs) } -> std::convertible_to<size_t>; // returns the count enqueued, in order
+    { q.dequeue_bulk(ptrs) } -> std::convertible_to<size_t>; // returns the count written to ptrs
+    { q.stats() } -> std::same_as<QueueStats>;
+    { q.reject(size_t{}) };  // counts messages a producer dropped after enqueue failed
 };
 
 /**************************************************************************
-Supported Q types include LockedQueue, CustomSPSCLockFreeQueue, BoostLockFreeQueue,
-CustomMPMCLockFreeQueue and MoodycamelLockFreeQueue. Check TestQueue.cpp for usage examples.
+Supported Q types include LockedQueue, CustomSPSCLockFreeQueue, CustomCachedSPSCLockFreeQueue,
+BoostLockFreeQueue, CustomMPMCLockFreeQueue and MoodycamelLockFreeQueue. Check TestQueue.cpp for usage examples.
 **************************************************************************/
 template <MyQ Q>
 class Queue {
 public:
-    Queue() { }
+    template <typename... Args>
+    requires std::constructible_from<Q, Args...>
+    explicit Queue(Args&&... args) : queue_(std::forward<Args>(args)...) { }
 	Queue(Queue const&) = delete;
 	Queue& operator=(Queue const&) = delete;
     Queue(Queue&&) = default;
     Queue& operator=(Queue&&) = default;
     bool enqueue(Q::value_type ptr) { return queue_.enqueue(ptr); }
     Q::value_type dequeue() { return queue_.dequeue(); }
+    size_t enqueue_bulk(std::span<typename Q::value_type> ptrs) { return queue_.enqueue_bulk(ptrs); }
+    size_t dequeue_bulk(std::span<typename Q::value_type> ptrs) { return queue_.dequeue_bulk(ptrs); }
+    bool empty() const { return queue_.empty(); }
+    QueueStats stats() const { return queue_.stats(); }
+    void reject(size_t count) { queue_.reject(count); }
 private:
     Q queue_;
 };
@@ -51,12 +114,16 @@ template<MsgPtr T>
 class LockedQueue {
 public:
     using value_type = T;
+    static constexpr bool multiProducer = true;
+    static constexpr bool multiConsumer = true;
     LockedQueue() {
         std::cout << "Using LockedQueue\n";
     }
     inline bool enqueue(T ptr) {
         std::lock_guard<std::mutex> lock(mutex_);
         queue_.push(ptr);
+        ++stats_.enqueued;
+        stats_.highWater = std::max<uint64_t>(stats_.highWater, queue_.size());
         cv_.notify_one();
         return true; 
     }
@@ -65,12 +132,47 @@ public:
         cv_.wait(lock, [&]{ return !queue_.empty(); });
         T msg = queue_.front();
         queue_.pop();
+        ++stats_.dequeued;
         return msg;
     }
+    inline size_t enqueue_bulk(std::span<T> ptrs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (T ptr : ptrs) {
+            queue_.push(ptr);
+        }
+        stats_.enqueued += ptrs.size();
+        stats_.highWater = std::max<uint64_t>(stats_.highWater, queue_.size());
+        cv_.notify_one();
+        return ptrs.size();
+    }
+    inline size_t dequeue_bulk(std::span<T> ptrs) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&]{ return !queue_.empty(); });
+        size_t count = 0;
+        while (count < ptrs.size() && !queue_.empty()) {
+            ptrs[count++] = queue_.front();
+            queue_.pop();
+        }
+        stats_.dequeued += count;
+        return count;
+    }
+    inline bool empty() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.empty();
+    }
+    inline QueueStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+    inline void reject(size_t count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.rejected += count;
+    }
 private:
     std::queue<T> queue_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
     std::condition_variable cv_;
+    QueueStats stats_;
 };
 
 /**************************************************************************/
@@ -78,38 +180,186 @@ template <MsgPtr T>
 class CustomSPSCLockFreeQueue {
 public:
     using value_type = T;
-    CustomSPSCLockFreeQueue() 
-            : buffer_(Const::queueCapacity)
-            , capacity_(Const::queueCapacity)
-            , mask_(Const::queueCapacity - 1) {
+    static constexpr bool multiProducer = false;
+    static constexpr bool multiConsumer = false;
+    explicit CustomSPSCLockFreeQueue(size_t capacity = Const::queueCapacity, PageOptions options = {})
+            : buffer_(capacity, options)
+            , capacity_(capacity)
+            , mask_(capacity - 1) {
         if (capacity_ == 0 || (capacity_ & mask_) != 0) {
             throw std::invalid_argument("Capacity must be a power of two and greater than zero.");
         }
-        std::cout << "Using CustomSPSCLockFreeQueue " << Const::queueCapacity << " capacity...\n";
+        std::cout << "Using CustomSPSCLockFreeQueue " << capacity_ << " capacity" 
+                  << (buffer_.hugePages() ? " on huge pages" : "") << "...\n";
     }
     inline bool enqueue(T ptr) {
         const size_t tail = tail_.load(std::memory_order_relaxed);
         const size_t next_tail = (tail + 1);
-        if (next_tail - head_.load(std::memory_order_acquire) > capacity_) {
+        const size_t head = head_.load(std::memory_order_acquire);
+        if (next_tail - head > capacity_) [[unlikely]] {
             return false;
         }
         buffer_[tail & mask_] = std::move(ptr);
         tail_.store(next_tail, std::memory_order_release);
+        updateHighWater(highWater_, next_tail, head);
         return true;
     }
     inline T dequeue() {
-        if (head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_relaxed)) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
             return nullptr; 
         }
-        const size_t head = head_.fetch_add(1, std::memory_order_acq_rel);
-        return buffer_[head & mask_];
+        T value = buffer_[head & mask_];   // read the slot before handing it back to the producer
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+    // Copies as many ptrs as fit and publishes them with a single tail_ store
+    inline size_t enqueue_bulk(std::span<T> ptrs) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t space = capacity_ - (tail - head);
+        const size_t count = std::min(space, ptrs.size());
+        for (size_t i = 0; i < count; ++i) {
+            buffer_[(tail + i) & mask_] = ptrs[i];
+        }
+        if (count > 0) {
+            tail_.store(tail + count, std::memory_order_release);
+            updateHighWater(highWater_, tail + count, head);
+        }
+        return count;
+    }
+    // Reads everything available (up to ptrs.size()) and releases the slots with a single head_ store
+    inline size_t dequeue_bulk(std::span<T> ptrs) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t available = tail_.load(std::memory_order_acquire) - head;
+        const size_t count = std::min(available, ptrs.size());
+        for (size_t i = 0; i < count; ++i) {
+            ptrs[i] = buffer_[(head + i) & mask_];
+        }
+        if (count > 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+    inline bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
     }
+    inline QueueStats stats() const {
+        QueueStats stats;
+        stats.dequeued = head_.load(std::memory_order_relaxed);
+        stats.enqueued = tail_.load(std::memory_order_relaxed);
+        stats.rejected = rejected_.load(std::memory_order_relaxed);
+        stats.highWater = highWater_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    inline void reject(size_t count) { rejected_.fetch_add(count, std::memory_order_relaxed); }
 private:
-    std::vector<T> buffer_;
+    HugePageBuffer<T> buffer_;
     alignas(64) std::atomic<size_t> head_{ 0 };
     alignas(64) std::atomic<size_t> tail_{ 0 };
     size_t capacity_{ 0 };
     size_t mask_{ 0 };
+    std::atomic<size_t> rejected_{ 0 };    // producer side
+    std::atomic<size_t> highWater_{ 0 };   // producer side
+};
+
+/**************************************************************************
+SPSC ring where each side keeps a local copy of the other side's index and only
+re-reads the shared one when the queue looks full (producer) or empty (consumer).
+Indices are published with plain release stores, no RMW on either side.
+**************************************************************************/
+template <MsgPtr T>
+class CustomCachedSPSCLockFreeQueue {
+public:
+    using value_type = T;
+    static constexpr bool multiProducer = false;
+    static constexpr bool multiConsumer = false;
+    explicit CustomCachedSPSCLockFreeQueue(size_t capacity = Const::queueCapacity, PageOptions options = {})
+            : buffer_(capacity, options)
+            , capacity_(capacity)
+            , mask_(capacity - 1) {
+        if (capacity_ == 0 || (capacity_ & mask_) != 0) {
+            throw std::invalid_argument("Capacity must be a power of two and greater than zero.");
+        }
+        std::cout << "Using CustomCachedSPSCLockFreeQueue " << capacity_ << " capacity" 
+                  << (buffer_.hugePages() ? " on huge pages" : "") << "...\n";
+    }
+    inline bool enqueue(T ptr) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ >= capacity_) [[unlikely]] {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ >= capacity_) {
+                return false;
+            }
+        }
+        buffer_[tail & mask_] = ptr;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    inline T dequeue() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) [[unlikely]] {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) {
+                return nullptr;
+            }
+            updateHighWater(highWater_, tailCache_, head); // exact occupancy at refresh time
+        }
+        T value = buffer_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+    inline size_t enqueue_bulk(std::span<T> ptrs) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (capacity_ - (tail - headCache_) < ptrs.size()) {
+            headCache_ = head_.load(std::memory_order_acquire);
+        }
+        const size_t count = std::min(capacity_ - (tail - headCache_), ptrs.size());
+        for (size_t i = 0; i < count; ++i) {
+            buffer_[(tail + i) & mask_] = ptrs[i];
+        }
+        if (count > 0) {
+            tail_.store(tail + count, std::memory_order_release);
+        }
+        return count;
+    }
+    inline size_t dequeue_bulk(std::span<T> ptrs) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (tailCache_ - head < ptrs.size()) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            updateHighWater(highWater_, tailCache_, head);
+        }
+        const size_t count = std::min(tailCache_ - head, ptrs.size());
+        for (size_t i = 0; i < count; ++i) {
+            ptrs[i] = buffer_[(head + i) & mask_];
+        }
+        if (count > 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+    inline bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    inline QueueStats stats() const {
+        QueueStats stats;
+        stats.dequeued = head_.load(std::memory_order_relaxed);
+        stats.enqueued = tail_.load(std::memory_order_relaxed);
+        stats.rejected = rejected_.load(std::memory_order_relaxed);
+        stats.highWater = highWater_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    inline void reject(size_t count) { rejected_.fetch_add(count, std::memory_order_relaxed); }
+private:
+    HugePageBuffer<T> buffer_;
+    size_t capacity_{ 0 };
+    size_t mask_{ 0 };
+    alignas(64) std::atomic<size_t> tail_{ 0 }; // written by producer
+    size_t headCache_{ 0 };                     // producer's view of head_
+    std::atomic<size_t> rejected_{ 0 };         // producer side
+    alignas(64) std::atomic<size_t> head_{ 0 }; // written by consumer
+    size_t tailCache_{ 0 };                     // consumer's view of tail_
+    std::atomic<size_t> highWater_{ 0 };        // consumer side, sampled whenever tailCache_ is refreshed
 };
 
 /**************************************************************************/
@@ -117,14 +367,17 @@ template <MsgPtr T>
 class CustomMPMCLockFreeQueue {
 public:
     using value_type = T;
-    CustomMPMCLockFreeQueue() 
-            : buffer_(Const::queueCapacity)
-            , capacity_(Const::queueCapacity)
-            , mask_(Const::queueCapacity - 1) {
+    static constexpr bool multiProducer = true;
+    static constexpr bool multiConsumer = true;
+    explicit CustomMPMCLockFreeQueue(size_t capacity = Const::queueCapacity, PageOptions options = {})
+            : buffer_(capacity, options)
+            , capacity_(capacity)
+            , mask_(capacity - 1) {
         if (capacity_ == 0 || (capacity_ & mask_) != 0) {
             throw std::invalid_argument("Capacity must be a power of two and greater than zero.");
         }
-        std::cout << "Using CustomMPMCLockFreeQueue " << Const::queueCapacity << " capacity...\n";
+        std::cout << "Using CustomMPMCLockFreeQueue " << capacity_ << " capacity" 
+                  << (buffer_.hugePages() ? " on huge pages" : "") << "...\n";
         for (size_t i = 0; i < capacity_; ++i) {
             buffer_[i].seq.store(i, std::memory_order_relaxed);
         }
@@ -150,6 +403,7 @@ public:
         }
         cell->data = ptr;
         cell->seq.store(pos + 1, std::memory_order_release);
+        updateHighWater(highWater_, pos + 1, head_.load(std::memory_order_relaxed));
         return true;
     }
     inline T dequeue() {
@@ -173,16 +427,94 @@ public:
         cell->seq.store(pos + capacity_, std::memory_order_release);
         return value;
     }
+    // Claims a run of consecutive free cells with a single tail_ CAS, then fills and publishes them
+    inline size_t enqueue_bulk(std::span<T> ptrs) {
+        if (ptrs.empty()) return 0;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (true) {
+            count = 0;
+            while (count < ptrs.size()) {
+                const size_t seq = buffer_[(pos + count) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + count) break;
+                ++count;
+            }
+            if (count == 0) {
+                const size_t seq = buffer_[pos & mask_].seq.load(std::memory_order_acquire);
+                if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos) < 0) {
+                    return 0; // full
+                }
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (tail_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            Cell& cell = buffer_[(pos + i) & mask_];
+            cell.data = ptrs[i];
+            cell.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        updateHighWater(highWater_, pos + count, head_.load(std::memory_order_relaxed));
+        return count;
+    }
+    // Claims a run of consecutive published cells with a single head_ CAS, then reads and recycles them
+    inline size_t dequeue_bulk(std::span<T> ptrs) {
+        if (ptrs.empty()) return 0;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (true) {
+            count = 0;
+            while (count < ptrs.size()) {
+                const size_t seq = buffer_[(pos + count) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + count + 1) break;
+                ++count;
+            }
+            if (count == 0) {
+                const size_t seq = buffer_[pos & mask_].seq.load(std::memory_order_acquire);
+                if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1) < 0) {
+                    return 0; // empty
+                }
+                pos = head_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (head_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            Cell& cell = buffer_[(pos + i) & mask_];
+            ptrs[i] = cell.data;
+            cell.seq.store(pos + i + capacity_, std::memory_order_release);
+        }
+        return count;
+    }
+    inline bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    inline QueueStats stats() const {
+        QueueStats stats;
+        stats.dequeued = head_.load(std::memory_order_relaxed);
+        stats.enqueued = tail_.load(std::memory_order_relaxed);
+        stats.rejected = rejected_.load(std::memory_order_relaxed);
+        stats.highWater = highWater_.load(std::memory_order_relaxed);
+        if (stats.dequeued > stats.enqueued) stats.dequeued = stats.enqueued; // racy snapshot
+        return stats;
+    }
+    inline void reject(size_t count) { rejected_.fetch_add(count, std::memory_order_relaxed); }
 private:
     struct Cell {
         std::atomic<size_t> seq;
         T data;
     };
-    std::vector<Cell> buffer_;
+    HugePageBuffer<Cell> buffer_;
     alignas(64) std::atomic<size_t> head_{ 0 };
     alignas(64) std::atomic<size_t> tail_{ 0 };
     size_t capacity_{ 0 };
     size_t mask_{ 0 };
+    alignas(64) std::atomic<size_t> rejected_{ 0 };
+    std::atomic<size_t> highWater_{ 0 };
 };
 
 /**************************************************************************/
@@ -190,21 +522,53 @@ template <MsgPtr T>
 class BoostLockFreeQueue {
 public:
     using value_type = T;
-    BoostLockFreeQueue() {
-        std::cout << "Using BoostLockFreeQueue " << Const::queueCapacity << " capacity...\n";
+    static constexpr bool multiProducer = true;
+    static constexpr bool multiConsumer = true;
+    // All nodes are allocated up front and bounded_push never allocates, so capacity is exact.
+    // Nodes are separate heap allocations, so there is no default: every instance states its size.
+    explicit BoostLockFreeQueue(size_t capacity) 
+            : queue_(capacity) {
+        std::cout << "Using BoostLockFreeQueue " << capacity << " capacity...\n";
     }
     inline bool enqueue(T ptr) {
-        return queue_.push(ptr);
+        if (!queue_.bounded_push(ptr)) [[unlikely]] {
+            return false;
+        }
+        counters_.onEnqueue(1);
+        return true;
     }
     inline T dequeue() {
         T msg = nullptr;
-        queue_.pop(msg);
+        if (!queue_.pop(msg)) {
+            return nullptr;     // a pop that lost its CAS and then found the queue empty may have written msg
+        }
+        counters_.onDequeue(1);
         return msg;
     }
+    inline size_t enqueue_bulk(std::span<T> ptrs) { // no native bulk push in boost::lockfree::queue
+        size_t count = 0;
+        while (count < ptrs.size() && queue_.bounded_push(ptrs[count])) {
+            ++count;
+        }
+        if (count > 0) counters_.onEnqueue(count);
+        return count;
+    }
+    inline size_t dequeue_bulk(std::span<T> ptrs) {
+        size_t count = 0;
+        while (count < ptrs.size() && queue_.pop(ptrs[count])) {
+            ++count;
+        }
+        if (count > 0) counters_.onDequeue(count);
+        return count;
+    }
+    inline bool empty() const {
+        return queue_.empty();
+    }
+    inline QueueStats stats() const { return counters_.snapshot(); }
+    inline void reject(size_t count) { counters_.onReject(count); }
 private:
-    boost::lockfree::queue<T, 
-        boost::lockfree::capacity<1024>, 
-        boost::lockfree::fixed_sized<true>> queue_;
+    boost::lockfree::queue<T> queue_;
+    QueueCounters counters_;
 };
 
 #ifdef USE_MOODYCAMEL_QUEUE
@@ -214,20 +578,100 @@ template <MsgPtr T>
 class MoodycamelLockFreeQueue {
 public:
     using value_type = T;
-    MoodycamelLockFreeQueue() : queue_(Const::queueCapacity) {
-        std::cout << "Using MoodycamelLockFreeQueue " << Const::queueCapacity << " capacity...\n";
+    static constexpr bool multiProducer = true;
+    static constexpr bool multiConsumer = true;
+    explicit MoodycamelLockFreeQueue(size_t capacity = Const::queueCapacity) : queue_(capacity) {
+        std::cout << "Using MoodycamelLockFreeQueue " << capacity << " capacity...\n";
     }
     inline bool enqueue(T ptr) {
-        return queue_.enqueue(ptr);
+        if (!queue_.enqueue(ptr)) [[unlikely]] {
+            return false;
+        }
+        counters_.onEnqueue(1);
+        return true;
     }
     inline T dequeue() {
         T msg = nullptr;
-        queue_.try_dequeue(msg);
+        if (!queue_.try_dequeue(msg)) {
+            return nullptr;
+        }
+        counters_.onDequeue(1);
         return msg;
     }
+    inline size_t enqueue_bulk(std::span<T> ptrs) {
+        if (!queue_.enqueue_bulk(ptrs.data(), ptrs.size())) [[unlikely]] {
+            return 0;
+        }
+        counters_.onEnqueue(ptrs.size());
+        return ptrs.size();
+    }
+    inline size_t dequeue_bulk(std::span<T> ptrs) {
+        const size_t count = queue_.try_dequeue_bulk(ptrs.data(), ptrs.size());
+        if (count > 0) counters_.onDequeue(count);
+        return count;
+    }
+    inline bool empty() const {
+        return queue_.size_approx() == 0;
+    }
+    inline QueueStats stats() const { return counters_.snapshot(); }
+    inline void reject(size_t count) { counters_.onReject(count); }
 private:
     moodycamel::ConcurrentQueue<T> queue_;
+    QueueCounters counters_;
 };
 #endif
 
+/**************************************************************************
+What a producing stage does when its output queue is full.
+    Block        - retry until there is room (or the stage is stopped)
+    DropOldest   - evict the oldest queued messages to make room, needs a multi-consumer queue
+    CountAndDrop - drop the new message
+Dropped messages are handed to the drop callback, which typically returns them to the pool,
+and counted once each in the queue's rejected stat. A blocked retry is not a rejection.
+**************************************************************************/
+enum class Backpressure { Block, DropOldest, CountAndDrop };
+
+template <MyQ Q>
+void checkBackpressure(Backpressure policy) {
+    if (policy == Backpressure::DropOldest && !Q::multiConsumer) {
+        throw std::invalid_argument("Backpressure::DropOldest requires a multi-consumer queue");
+    }
+}
+
+template <MyQ Q, typename DropFn>
+inline bool enqueueWithBackpressure(Q& queue, typename Q::value_type msg, Backpressure policy, 
+                                    const std::atomic<bool>& runFlag, DropFn&& drop) {
+    if (queue.enqueue(msg)) [[likely]] {
+        return true;
+    }
+    switch (policy) {
+        case Backpressure::Block:
+            while (!queue.enqueue(msg)) {
+                if (!runFlag.load(std::memory_order_relaxed)) {
+                    queue.reject(1);
+                    drop(msg);
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            return true;
+        case Backpressure::DropOldest:
+            if constexpr (Q::multiConsumer) {
+                while (!queue.enqueue(msg)) {
+                    if (auto oldest = queue.dequeue()) {
+                        queue.reject(1);
+                        drop(oldest);
+                    }
+                }
+                return true;
+            }
+            [[fallthrough]];
+        case Backpressure::CountAndDrop:
+            queue.reject(1);
+            drop(msg);
+            return false;
+    }
+    return false;
+}
+
 /**************************************************************************/
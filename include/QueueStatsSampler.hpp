@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include <mutex>
+#include "Queue.hpp"
+#include "AsyncLogger.hpp"
+
+/**************************************************************************
+Periodically logs occupancy, high-water mark and drop counters of the pipeline
+queues (and any extra counters such as a stage's dropped messages) through the
+AsyncLogger, so the hot path only pays for relaxed counter updates.
+Register everything with add()/addCounter() before start().
+**************************************************************************/
+class QueueStatsSampler {
+public:
+    using StatsFn = std::function<QueueStats()>;
+    using CounterFn = std::function<uint64_t()>;
+
+    QueueStatsSampler(AsyncLogger& logger, std::chrono::milliseconds interval = std::chrono::milliseconds(1000))
+            : logger_(logger)
+            , interval_(interval) {
+
+    }
+    ~QueueStatsSampler() {
+        stop();
+    }
+    template <typename Q>
+    void add(const std::string& name, const Q& queue) {
+        queues_.push_back({ name, [&queue]() { return queue.stats(); } });
+    }
+    void addCounter(const std::string& name, CounterFn fn) {
+        counters_.push_back({ name, std::move(fn) });
+    }
+    void start() {
+        runFlag_ = true;
+        thread_ = std::thread(&QueueStatsSampler::run, this);
+    }
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            runFlag_ = false;
+        }
+        cv_.notify_one();
+        if (thread_.joinable())
+            thread_.join();
+    }
+    // Logs one line per registered queue and counter
+    void sample() {
+        for (const auto& [name, fn] : queues_) {
+            const QueueStats stats = fn();
+            logger_.log("QueueStats %s size:%llu highWater:%llu enqueued:%llu dequeued:%llu rejected:%llu\n",
+                        name.c_str(), (unsigned long long)stats.size(), (unsigned long long)stats.highWater,
+                        (unsigned long long)stats.enqueued, (unsigned long long)stats.dequeued,
+                        (unsigned long long)stats.rejected);
+        }
+        for (const auto& [name, fn] : counters_) {
+            logger_.log("Counter %s %llu\n", name.c_str(), static_cast<unsigned long long>(fn()));
+        }
+    }
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (runFlag_) {
+            if (cv_.wait_for(lock, interval_, [this] { return !runFlag_; }))
+                break;
+            sample();
+        }
+        sample();   // Final snapshot on shutdown
+    }
+    AsyncLogger& logger_;
+    std::chrono::milliseconds interval_;
+    std::vector<std::pair<std::string, StatsFn>> queues_;
+    std::vector<std::pair<std::string, CounterFn>> counters_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool runFlag_ = false;
+};
+
+/**************************************************************************/
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HashMap.hpp"
+
+namespace Const {
+#ifndef SYMBOL_TABLE_CAPACITY
+    constexpr size_t symbolTableCapacity = 1024;   // Symbols expected per table, it grows past this
+#else
+    constexpr size_t symbolTableCapacity = SYMBOL_TABLE_CAPACITY;
+#endif
+};
+
+using SymbolId = uint32_t;
+
+// The 8-byte symbol field of a message as one integer, so a symbol compares in one instruction
+inline uint64_t symbolKey(const char (&symbol)[8]) {
+    uint64_t key;
+    std::memcpy(&key, symbol, sizeof(key));
+    return key;
+}
+
+/**************************************************************************
+Interns the 8-byte symbol field of messages to dense ids 0, 1, 2 ... in the
+order symbols are first seen. After a symbol's first message, intern() is one
+hash probe on a uint64_t with no allocation, and the id can index arrays, maps
+or order books directly. The name is copied once, on the first intern.
+Symbols are zero-padded ASCII, so the raw key is mixed with MurmurHash:
+ETHUSDC and ETHUSDT only differ in their high bytes.
+A table belongs to a single thread, and every consumer stage owns its own.
+**************************************************************************/
+class SymbolTable {
+public:
+    static constexpr SymbolId InvalidId = UINT32_MAX;
+
+    explicit SymbolTable(size_t capacity = Const::symbolTableCapacity)
+            : ids_(std::bit_ceil(std::max<size_t>(16, capacity * 2))) {
+        names_.reserve(capacity);
+    }
+    SymbolTable(SymbolTable const&) = delete;
+    SymbolTable& operator=(SymbolTable const&) = delete;
+
+    // Id of symbol, assigning the next one if it is new
+    SymbolId intern(const char (&symbol)[8]) {
+        const uint64_t key = symbolKey(symbol);
+        if (const SymbolId* id = ids_.find(key)) {
+            return *id;
+        }
+        const SymbolId id = static_cast<SymbolId>(names_.size());
+        ids_.insert(key, id);
+        names_.emplace_back(symbol, strnlen(symbol, sizeof(symbol)));
+        return id;
+    }
+    // Id of symbol, InvalidId if it was never interned
+    SymbolId find(const char (&symbol)[8]) {
+        const SymbolId* id = ids_.find(symbolKey(symbol));
+        return (id != nullptr) ? *id : InvalidId;
+    }
+    std::string_view name(SymbolId id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+private:
+    HashMap<RobinHoodHashMap<uint64_t, SymbolId, MurmurHash<uint64_t>>> ids_;
+    std::vector<std::string> names_;
+};
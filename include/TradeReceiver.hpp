@@ -2,9 +2,11 @@
 #include <chrono>
 #include <functional>
 #include <fstream>
+#include <array>
 
 #include "Socket.hpp"
 #include "Queue.hpp"
+#include "WaitStrategy.hpp"
 #include "HashMap.hpp"
 #include "MemoryPool.hpp"
 #include "AsyncLogger.hpp"
@@ -104,6 +106,7 @@ private:
             int nfds = epoll_wait(epollFD.get(), &event, 1, 5000);  // 5s timeout
             if (nfds > 0 && event.events & EPOLLIN) [[likely]] {
                 TradeMsgPtr msg = msgPool_.allocate();
+                trackOwner(msgPool_, msg, "TradeRecoveryManager");
                 ssize_t bytes = recv(socketFD_.get(), msg, ITCHTradeMsgSize, MSG_WAITALL);
                 if (bytes != ITCHTradeMsgSize) [[unlikely]] {
                     msgPool_.deallocate(msg);
@@ -140,18 +143,21 @@ private:
 };
 
 /**************************************************************************/
-template <typename TradeMsg, MyQ RecvMsgQueue, MyQ SendMsgQueue, MyPool Pool>
+template <typename TradeMsg, MyQ RecvMsgQueue, MyQ SendMsgQueue, MyPool Pool, typename Wait = YieldWait>
 class TradeDataSequencer {
 public:
     using TradeMsgPtr = TradeMsg*;
 
-    TradeDataSequencer(RecvMsgQueue& recvQueue, SendMsgQueue& sendQueue, Pool& pool, AsyncLogger& logger) 
+    // Downstream must see every sequenced message, so the default is to block on a full queue
+    TradeDataSequencer(RecvMsgQueue& recvQueue, SendMsgQueue& sendQueue, Pool& pool, AsyncLogger& logger,
+                       Backpressure policy = Backpressure::Block) 
             : recvQueue_(recvQueue)
             , sendQueue_(sendQueue)
             , msgPool_(pool)
             , tradeRecoveryManager_([this](TradeMsgPtr msg) { onRecoveredMsg(msg); }, pool, logger)
-            , logger_(logger) {
-        
+            , logger_(logger)
+            , policy_(policy) {
+        checkBackpressure<SendMsgQueue>(policy_);
     }
     ~TradeDataSequencer() {
         
@@ -163,53 +169,72 @@ public:
     void run() {
         logger_.log("TradeDataSequencer run\n");
         tradeRecoveryManager_.connect();
+        std::array<TradeMsgPtr, Const::queueBulkSize> msgs;
         while (runFlag_.load(std::memory_order_relaxed)) {
-            TradeMsgPtr msg = recvQueue_.dequeue();
-            if (!msg) {
-                std::this_thread::yield();
+            const size_t count = recvQueue_.dequeue_bulk(msgs);
+            if (count == 0) {
+                wait_.idle(recvQueue_);
                 continue;
             }
-            if (msg->sequence_number > nextSequence_) [[unlikely]] {
-                // TODO : Send an invalidate message, avoid taking decisions on stale data
-                logger_.log("Gap from %llu to %llu, initiating recovery\n", 
-                                nextSequence_, msg->sequence_number - 1);
-                tradeRecoveryManager_.recover(nextSequence_, msg->sequence_number - 1); // Blocking, required to keep the sequence
-                // TODO : Not here, but send a validate message, considering some condition
-            } 
-            else if (msg->sequence_number < nextSequence_) [[unlikely]] { // Old message received, drop message   
-                if constexpr (Config::debug) 
-                    logger_.log("MC Old msg received, drop! expected %llu, got %llu\n", 
-                                nextSequence_, msg->sequence_number);
-                msgPool_.deallocate(msg);
-                continue;
+            wait_.reset();
+            for (size_t i = 0; i < count; ++i) {
+                trackOwner(msgPool_, msgs[i], "TradeDataSequencer");
+                onMsg(msgs[i]);
             }
-            if constexpr (Config::debug) 
-                logger_.log("TradeDataSequencer received msg %llu\n", msg->sequence_number);
-            sendQueue_.enqueue(msg);
-            ++nextSequence_;
         }  
         logger_.log("TradeDataSequencer stop @run\n");  
     }
 
     void setSequenceNum(uint64_t sequence) { nextSequence_ = (sequence + 1); }
     uint64_t getSequenceNum() const { return (nextSequence_ - 1); }
+    uint64_t droppedMsgs() const { return droppedMsgs_.load(std::memory_order_relaxed); }
 
 private:
+    void onMsg(TradeMsgPtr msg) {
+        if (msg->sequence_number > nextSequence_) [[unlikely]] {
+            // TODO : Send an invalidate message, avoid taking decisions on stale data
+            logger_.log("Gap from %llu to %llu, initiating recovery\n", 
+                            nextSequence_, msg->sequence_number - 1);
+            tradeRecoveryManager_.recover(nextSequence_, msg->sequence_number - 1); // Blocking, required to keep the sequence
+            // TODO : Not here, but send a validate message, considering some condition
+        } 
+        else if (msg->sequence_number < nextSequence_) [[unlikely]] { // Old message received, drop message   
+            if constexpr (Config::debug) 
+                logger_.log("MC Old msg received, drop! expected %llu, got %llu\n", 
+                            nextSequence_, msg->sequence_number);
+            msgPool_.deallocate(msg);
+            return;
+        }
+        if constexpr (Config::debug) 
+            logger_.log("TradeDataSequencer received msg %llu\n", msg->sequence_number);
+        send(msg);
+        ++nextSequence_;
+    }
     void onRecoveredMsg(TradeMsgPtr msg) {
         if (msg->sequence_number != nextSequence_) [[unlikely]] {
             std::cerr << "Unrecoverable Gap [received seq: " << msg->sequence_number << "] [" <<
                 "expected: " << nextSequence_ << "\n";
             throw std::runtime_error("Failed to recover message");
         }
-        sendQueue_.enqueue(msg);
+        send(msg);
         ++nextSequence_;
     }
+    inline void send(TradeMsgPtr msg) {
+        trackOwner(msgPool_, msg, "SequencerToDownstreamQ");
+        enqueueWithBackpressure(sendQueue_, msg, policy_, runFlag_, [this](TradeMsgPtr dropped) {
+            droppedMsgs_.fetch_add(1, std::memory_order_relaxed);
+            msgPool_.deallocate(dropped);
+        });
+    }
     RecvMsgQueue& recvQueue_;
     SendMsgQueue& sendQueue_;
     Pool& msgPool_;
     TradeRecoveryManager<TradeMsg, Pool> tradeRecoveryManager_;
     AsyncLogger& logger_;
     uint64_t nextSequence_ = 0;
+    Backpressure policy_;
+    Wait wait_;
+    std::atomic<uint64_t> droppedMsgs_{ 0 };
     alignas(64) std::atomic<bool> runFlag_{true};
 };
 
@@ -219,11 +244,14 @@ class MulticastTradeDataReceiver {
 public:
     using TradeMsgPtr = TradeMsg*;
 
-    MulticastTradeDataReceiver(SendMsgQueue& queue, Pool& pool, AsyncLogger& logger) 
+    // Dropping is safe here, the sequencer recovers the resulting gap from the recovery server
+    MulticastTradeDataReceiver(SendMsgQueue& queue, Pool& pool, AsyncLogger& logger,
+                               Backpressure policy = Backpressure::CountAndDrop) 
             : queue_(queue)
             , pool_(pool)
-            , logger_(logger) {
-        
+            , logger_(logger)
+            , policy_(policy) {
+        checkBackpressure<SendMsgQueue>(policy_);
     }
     ~MulticastTradeDataReceiver() {}
     void stop() {
@@ -271,21 +299,28 @@ public:
             if (!msg) {
                 throw std::runtime_error("Msg Pool exhausted at MulticastTradeDataReceiver");
             }
+            trackOwner(pool_, msg, "MulticastTradeDataReceiver");
             ssize_t len = recv(socketFD_.get(), msg, ITCHTradeMsgSize, 0);
             if (len < 0) [[unlikely]] {
                 std::cerr << "MulticastTradeDataReceiver recv failed";
                 pool_.deallocate(msg);
                 continue;
             }
-            queue_.enqueue(msg);
+            enqueueWithBackpressure(queue_, msg, policy_, runFlag_, [this](TradeMsgPtr dropped) {
+                droppedMsgs_.fetch_add(1, std::memory_order_relaxed);
+                pool_.deallocate(dropped);
+            });
             //if constexpr (Config::debug) logger_.log("MC received msg %llu\n", msg->sequence_number);
         }
         logger_.log("stopped MulticastTradeDataReceiver @run\n");
     }
+    uint64_t droppedMsgs() const { return droppedMsgs_.load(std::memory_order_relaxed); }
 private:
     SendMsgQueue& queue_;
     Pool& pool_;
     AsyncLogger& logger_;
     Socket socketFD_{-1};
+    Backpressure policy_;
+    std::atomic<uint64_t> droppedMsgs_{ 0 };
     alignas(64) std::atomic<bool> runFlag_{true};
 };
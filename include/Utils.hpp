@@ -1,8 +1,11 @@
 #pragma once
 
 #include <unistd.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <filesystem>
+#include <iostream>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "Queue.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace Const {
+#ifndef WAIT_SPIN_COUNT
+    constexpr uint32_t waitSpinCount = 1000;    // Empty polls before starting to pause
+#else
+    constexpr uint32_t waitSpinCount = WAIT_SPIN_COUNT;
+#endif
+#ifndef WAIT_PAUSE_COUNT
+    constexpr uint32_t waitPauseCount = 1000;   // Paused polls before parking
+#else
+    constexpr uint32_t waitPauseCount = WAIT_PAUSE_COUNT;
+#endif
+    constexpr std::chrono::microseconds parkTimeout{1000}; // Upper bound on a park, so stop() is observed
+};
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**************************************************************************
+Wraps any MyQ with a futex a consumer can park on. Producers pay one fence and
+one load of a mostly-shared cache line per enqueue, and only make the wake
+syscall when a consumer is actually parked.
+**************************************************************************/
+template <MyQ Q>
+requires requires(Q q) { { q.empty() } -> std::convertible_to<bool>; }
+class WaitableQueue {
+public:
+    using value_type = typename Q::value_type;
+    static constexpr bool multiProducer = Q::multiProducer;
+    static constexpr bool multiConsumer = Q::multiConsumer;
+    template <typename... Args>
+    requires std::constructible_from<Q, Args...>
+    explicit WaitableQueue(Args&&... args) : queue_(std::forward<Args>(args)...) { }
+    WaitableQueue(WaitableQueue const&) = delete;
+    WaitableQueue& operator=(WaitableQueue const&) = delete;
+
+    inline bool enqueue(value_type ptr) {
+        const bool ok = queue_.enqueue(ptr);
+        if (ok) wakeIfParked();
+        return ok;
+    }
+    inline value_type dequeue() { return queue_.dequeue(); }
+    inline size_t enqueue_bulk(std::span<value_type> ptrs) {
+        const size_t count = queue_.enqueue_bulk(ptrs);
+        if (count > 0) wakeIfParked();
+        return count;
+    }
+    inline size_t dequeue_bulk(std::span<value_type> ptrs) { return queue_.dequeue_bulk(ptrs); }
+    inline bool empty() const { return queue_.empty(); }
+    inline QueueStats stats() const { return queue_.stats(); }
+    inline void reject(size_t count) { queue_.reject(count); }
+
+    // Blocks the calling consumer until an enqueue wakes it or the timeout expires
+    void park(std::chrono::microseconds timeout) {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const uint32_t epoch = epoch_.load(std::memory_order_acquire);
+        if (queue_.empty()) {
+            timespec ts{};
+            ts.tv_sec = timeout.count() / 1'000'000;
+            ts.tv_nsec = (timeout.count() % 1'000'000) * 1000;
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE,
+                    epoch, &ts, nullptr, 0);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    // Wakes every parked consumer, e.g. from a stage's stop()
+    void wakeAll() {
+        epoch_.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, INT_MAX,
+                nullptr, nullptr, 0);
+    }
+private:
+    inline void wakeIfParked() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) != 0) [[unlikely]] {
+            wakeAll();
+        }
+    }
+    Q queue_;
+    alignas(64) std::atomic<uint32_t> epoch_{ 0 };
+    alignas(64) std::atomic<uint32_t> waiters_{ 0 };
+};
+
+/**************************************************************************
+Idle strategies used by stage run loops when a dequeue comes back empty.
+idle() is called on every empty poll and reset() after a successful one.
+Check TestQueue.cpp for usage examples.
+**************************************************************************/
+struct BusySpinWait {     // Lowest latency, burns a full core
+    template <typename Q>
+    inline void idle(Q&) { cpuRelax(); }
+    inline void reset() { }
+};
+
+struct YieldWait {        // Previous behaviour of every stage
+    template <typename Q>
+    inline void idle(Q&) { std::this_thread::yield(); }
+    inline void reset() { }
+};
+
+class AdaptiveWait {      // Spin, then pause, then park on the queue (or sleep if it can't be parked on)
+public:
+    template <typename Q>
+    inline void idle(Q& queue) {
+        if (polls_ < Const::waitSpinCount) {
+            ++polls_;
+        }
+        else if (polls_ < Const::waitSpinCount + Const::waitPauseCount) {
+            ++polls_;
+            cpuRelax();
+        }
+        else if constexpr (requires { queue.park(Const::parkTimeout); }) {
+            queue.park(Const::parkTimeout);
+        }
+        else {
+            std::this_thread::sleep_for(Const::parkTimeout);
+        }
+    }
+    inline void reset() { polls_ = 0; }
+private:
+    uint32_t polls_ = 0;
+};
+
+/**************************************************************************/
@@ -0,0 +1,677 @@
+/*
+$ g++ -std=c++20 -O3 -o BenchHashMap BenchHashMap.cpp -I../include -I..
+$ ./BenchHashMap [--runs=suite,hashers,intervals,concurrent,growth] [--buckets=65536]
+                 [--symbol-buckets=4096] [--trades-dir=<dir of Binance trade csv files>]
+                 [--keys=65536] [--stride=4096] [--growth-keys=4194304] [--symbols=200]
+                 [--trades-per-interval=1000] [--max-threads=8] [--write-pct=5] [--format=text|csv]
+
+The suite run fills every map to 25%, 50%, 70% and 85% of --buckets (the bucket
+count it is constructed with; maps with a lower maximum load grow during the fill)
+and times every single operation:
+    insert - the fill itself
+    hit    - finds of every inserted key, in random order
+    miss   - as many finds of keys of the same stream that were never inserted
+    erase  - every inserted key, in random order, after the mixed run
+    mixed  - one op per live key: 60% hit, 10% miss, 15% insert, 15% erase
+It reports p50/p99/p99.9 per operation (timer overhead removed) and the memory
+per entry, read as the resident set growth of a forked child that builds the
+same map with transparent huge pages off, so allocator slack and preallocated
+node pools are charged to the map. Key streams:
+    sequential - 0, 1, 2 ... like exchange order ids
+    random     - uniform 64-bit ids
+    trade-id   - Binance trade ids: every symbol counts up from its own base and
+                 symbols trade with Zipf-skewed activity, so the map sees many
+                 interleaved sequential runs; with --trades-dir the ids are read
+                 from real trade files instead, in timestamp order
+    symbol     - exchange symbol strings (BTCUSDT-like) in maps of --symbol-buckets
+
+The hashers run times insert, hit lookup, miss lookup and erase of --keys keys for
+every map and hasher, per key pattern:
+    sequential - as above
+    strided    - 0, stride, 2 * stride ... like ids carrying a per-session offset in
+                 their low bits; with std::hash (the identity) and a power of two
+                 stride they share a handful of buckets
+    random     - as above
+Misses use the next --keys keys of the same pattern, so they probe the same region.
+
+The interval run mimics the trade aggregator: --symbols string keys updated
+--trades-per-interval times, then iterated and cleared, for the iterable maps.
+
+The concurrent run shares --symbols symbols between 1, 2, 4 ... --max-threads pinned
+threads that each load a random symbol and, --write-pct percent of the time, update
+it instead: ConcurrentHashMap against STLHashMap behind one mutex.
+
+The growth run inserts --growth-keys sequential keys into maps that start with 1024
+buckets and reports per-insert percentiles and the worst insert, which is where a
+stop-the-world rehash shows up.
+*/
+
+#include "HashMap.hpp"
+#include "BenchUtils.hpp"
+#include "Utils.hpp"
+
+#include <malloc.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct BenchConfig {
+    std::string runs = "suite,hashers,intervals,concurrent,growth";
+    size_t buckets = 1 << 16;
+    size_t symbolBuckets = 1 << 12;
+    std::string tradesDir;
+    size_t keys = 1 << 16;
+    uint64_t stride = 1 << 12;
+    size_t growthKeys = 1 << 22;
+    size_t symbols = 200;
+    size_t tradesPerInterval = 1000;
+    size_t maxThreads = 8;
+    size_t writePct = 5;
+    size_t concurrentOps = 1'000'000;   // per thread
+    std::string format = "text";
+};
+
+enum class KeyPattern { Sequential, Strided, Random };
+
+const char* patternName(KeyPattern pattern) {
+    switch (pattern) {
+    case KeyPattern::Sequential: return "sequential";
+    case KeyPattern::Strided: return "strided";
+    default: return "random";
+    }
+}
+
+// 2 * count distinct keys, the first half is inserted and the second half is looked up as misses
+std::vector<uint64_t> makeKeys(KeyPattern pattern, size_t count, uint64_t stride) {
+    std::vector<uint64_t> keys(2 * count);
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        switch (pattern) {
+        case KeyPattern::Sequential: keys[i] = i; break;
+        case KeyPattern::Strided: keys[i] = i * stride; break;
+        default: keys[i] = rng(); break;
+        }
+    }
+    return keys;
+}
+
+struct BenchResult {
+    double insertNs = 0;    // per key
+    double hitNs = 0;
+    double missNs = 0;
+    double eraseNs = 0;
+};
+
+/**************************************************************************/
+template <typename HM>
+BenchResult benchMap(const std::vector<uint64_t>& keys) {
+    const size_t count = keys.size() / 2;
+    auto hm = std::make_unique<HashMap<HM>>();
+    BenchResult result;
+    auto perKey = [count](uint64_t start) { return bench::TscClock::toNs(bench::rdtsc() - start) / count; };
+
+    uint64_t start = bench::rdtsc();
+    for (size_t i = 0; i < count; ++i) {
+        hm->insert(keys[i], i);
+    }
+    result.insertNs = perKey(start);
+
+    uint64_t sum = 0;
+    start = bench::rdtsc();
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t* value = hm->find(keys[i]);
+        sum += (value != nullptr) ? *value : 0;
+    }
+    result.hitNs = perKey(start);
+
+    size_t misses = 0;
+    start = bench::rdtsc();
+    for (size_t i = count; i < keys.size(); ++i) {
+        misses += hm->contains(keys[i]) ? 0 : 1;
+    }
+    result.missNs = perKey(start);
+
+    size_t erased = 0;
+    start = bench::rdtsc();
+    for (size_t i = 0; i < count; ++i) {
+        erased += hm->erase(keys[i]) ? 1 : 0;
+    }
+    result.eraseNs = perKey(start);
+
+    if (sum != count * (count - 1) / 2 || misses != count || erased != count) {
+        throw std::runtime_error("BenchHashMap: map returned wrong results");
+    }
+    return result;
+}
+
+void printResult(std::ostream& out, const BenchConfig& cfg, const std::string& map, const std::string& hasher,
+                 KeyPattern pattern, const BenchResult& r) {
+    if (cfg.format == "csv") {
+        out << map << "," << hasher << "," << patternName(pattern) << "," << cfg.keys << "," << r.insertNs << ","
+            << r.hitNs << "," << r.missNs << "," << r.eraseNs << "\n";
+    }
+    else {
+        out << "\t" << map << "<" << hasher << "> " << patternName(pattern) << ": insert " << r.insertNs
+            << " ns, hit " << r.hitNs << " ns, miss " << r.missNs << " ns, erase " << r.eraseNs << " ns\n";
+    }
+}
+
+template <template <typename, typename, typename> class Map>
+void benchHashers(std::ostream& out, const BenchConfig& cfg, const std::string& map) {
+    for (KeyPattern pattern : { KeyPattern::Sequential, KeyPattern::Strided, KeyPattern::Random }) {
+        const std::vector<uint64_t> keys = makeKeys(pattern, cfg.keys, cfg.stride);
+        auto run = [&]<typename Hasher>(const std::string& hasher) {
+            printResult(out, cfg, map, hasher, pattern, benchMap<Map<uint64_t, uint64_t, Hasher>>(keys));
+        };
+        run.template operator()<std::hash<uint64_t>>("std::hash");
+        run.template operator()<MurmurHash<uint64_t>>("MurmurHash");
+        run.template operator()<WyHash<uint64_t>>("WyHash");
+        run.template operator()<FibonacciHash<uint64_t>>("FibonacciHash");
+    }
+}
+
+/**************************************************************************
+Suite: per-op percentiles and memory per entry at several load factors
+**************************************************************************/
+enum class KeyStream { Sequential, Random, TradeId, Symbol };
+
+const char* streamName(KeyStream stream) {
+    switch (stream) {
+    case KeyStream::Sequential: return "sequential";
+    case KeyStream::Random: return "random";
+    case KeyStream::TradeId: return "trade-id";
+    default: return "symbol";
+    }
+}
+
+// Binance numbers trades per symbol from a large base; a few symbols carry most of the flow
+std::vector<uint64_t> syntheticTradeIds(size_t count) {
+    constexpr size_t symbols = 64;
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> next(symbols);
+    std::vector<double> activity(symbols);
+    for (size_t s = 0; s < symbols; ++s) {
+        next[s] = (s + 1) * 1'000'000'000ull + rng() % 500'000'000;
+        activity[s] = 1.0 / (s + 1);
+    }
+    std::discrete_distribution<size_t> pick(activity.begin(), activity.end());
+    std::vector<uint64_t> keys(count);
+    for (auto& key : keys) {
+        key = next[pick(rng)]++;
+    }
+    return keys;
+}
+
+// Trade ids of every csv file in dir in timestamp order, ids repeated across symbols kept once
+std::vector<uint64_t> fileTradeIds(const std::string& dir, size_t count) {
+    TradeMsgStore store(dir);
+    std::unordered_set<uint64_t> seen;
+    std::vector<uint64_t> keys;
+    for (size_t i = 0; i < store.size() && keys.size() < count; ++i) {
+        const uint64_t id = store.get(i)->trade_id;
+        if (seen.insert(id).second) {
+            keys.push_back(id);
+        }
+    }
+    if (keys.size() < count) {
+        throw std::runtime_error("BenchHashMap: " + dir + " holds " + std::to_string(keys.size()) +
+                                 " distinct trade ids, the suite needs " + std::to_string(count));
+    }
+    return keys;
+}
+
+// count distinct keys in arrival order; the first half is inserted and the second half never is
+std::vector<uint64_t> makeStream(KeyStream stream, size_t count, const BenchConfig& cfg) {
+    if (stream == KeyStream::TradeId) {
+        return cfg.tradesDir.empty() ? syntheticTradeIds(count) : fileTradeIds(cfg.tradesDir, count);
+    }
+    std::vector<uint64_t> keys(count);
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = (stream == KeyStream::Sequential) ? i : rng();
+    }
+    return keys;
+}
+
+// BTCUSDT-like names: a 3 to 6 letter base asset followed by a quote asset
+std::vector<std::string> makeSymbols(size_t count) {
+    static const char* quotes[] = { "USDT", "USDC", "FDUSD", "BTC", "ETH", "TRY" };
+    std::mt19937_64 rng(42);
+    std::set<std::string> seen;
+    std::vector<std::string> symbols;
+    while (symbols.size() < count) {
+        std::string symbol(3 + rng() % 4, 'A');
+        for (char& c : symbol) c = static_cast<char>('A' + rng() % 26);
+        symbol += quotes[rng() % std::size(quotes)];
+        if (seen.insert(symbol).second) {
+            symbols.push_back(std::move(symbol));
+        }
+    }
+    return symbols;
+}
+
+template <typename F>
+inline void timeOp(bench::LatencyHistogram& histogram, F&& op) {
+    const uint64_t start = bench::rdtsc();
+    op();
+    bench::recordTicks(histogram, start, bench::rdtsc());
+}
+
+// Resident bytes of this process, including hugetlbfs pages that the RSS counters leave out
+size_t residentBytes() {
+    size_t pages = 0, resident = 0;
+    std::ifstream("/proc/self/statm") >> pages >> resident;
+    size_t hugetlbKb = 0;
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.starts_with("HugetlbPages:")) hugetlbKb = std::stoull(line.substr(13));
+    }
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) + hugetlbKb * 1024;
+}
+
+// Resident set growth per entry of a map holding keys[0, count), measured in a child so
+// the parent's freed heap can't hide the map's pages; 0 if the child can't run
+template <typename HM, typename K>
+double bytesPerEntry(const std::vector<K>& keys, size_t count, size_t buckets) {
+    int fds[2];
+    if (pipe(fds) != 0) return 0;
+    const pid_t pid = fork();
+    if (pid == 0) {
+        std::cout.rdbuf(nullptr);
+        prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0);
+        malloc_trim(0);
+        const size_t before = residentBytes();
+        auto hm = std::make_unique<HashMap<HM>>(buckets);
+        for (size_t i = 0; i < count; ++i) {
+            hm->insert(keys[i], i);
+        }
+        const double perEntry = static_cast<double>(residentBytes() - before) / count;
+        const bool sent = write(fds[1], &perEntry, sizeof(perEntry)) == sizeof(perEntry);
+        _exit(sent ? 0 : 1);
+    }
+    close(fds[1]);
+    double perEntry = 0;
+    if (pid < 0 || read(fds[0], &perEntry, sizeof(perEntry)) != sizeof(perEntry)) {
+        perEntry = 0;
+    }
+    close(fds[0]);
+    if (pid > 0) waitpid(pid, nullptr, 0);
+    return perEntry;
+}
+
+struct SuiteResult {
+    bench::LatencyHistogram insert, hit, miss, erase, mixed;     // TSC ticks per op
+    double bytesPerEntry = 0;
+};
+
+// keys holds 2 * count keys: [0, count) is the fill, [count, 2 * count) misses and mixed inserts
+template <typename HM, typename K>
+SuiteResult benchOps(const std::vector<K>& keys, size_t count, size_t buckets) {
+    SuiteResult result;
+    std::mt19937_64 rng(7);
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    auto hm = std::make_unique<HashMap<HM>>(buckets);
+    size_t checks = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        timeOp(result.insert, [&] { hm->insert(keys[i], i); });
+    }
+    for (size_t i : order) {
+        timeOp(result.hit, [&] { checks += (hm->find(keys[i]) != nullptr) ? 1 : 0; });
+    }
+    for (size_t i = count; i < 2 * count; ++i) {
+        timeOp(result.miss, [&] { checks += hm->contains(keys[i]) ? 0 : 1; });
+    }
+
+    // live holds indices of inserted keys, spare keys [next, 2 * count) are still absent
+    std::vector<size_t> live = order;
+    size_t next = count;
+    for (size_t op = 0; op < count; ++op) {
+        const uint64_t r = rng();
+        const size_t pct = r % 100;
+        if (pct < 60 && !live.empty()) {
+            const size_t i = live[(r >> 8) % live.size()];
+            timeOp(result.mixed, [&] { checks += (hm->find(keys[i]) != nullptr) ? 1 : 0; });
+        }
+        else if (pct < 70 && next < 2 * count) {
+            const size_t i = next + (r >> 8) % (2 * count - next);
+            timeOp(result.mixed, [&] { checks += hm->contains(keys[i]) ? 0 : 1; });
+        }
+        else if (pct < 85 && next < 2 * count) {
+            const size_t i = next++;
+            timeOp(result.mixed, [&] { hm->insert(keys[i], i); });
+            live.push_back(i);
+            ++checks;
+        }
+        else if (!live.empty()) {
+            const size_t slot = (r >> 8) % live.size();
+            const size_t i = live[slot];
+            timeOp(result.mixed, [&] { checks += hm->erase(keys[i]) ? 1 : 0; });
+            live[slot] = live.back();
+            live.pop_back();
+        }
+        else {
+            ++checks;
+        }
+    }
+    std::shuffle(live.begin(), live.end(), rng);
+    for (size_t i : live) {
+        timeOp(result.erase, [&] { checks += hm->erase(keys[i]) ? 1 : 0; });
+    }
+    if (checks != 3 * count + live.size()) {
+        throw std::runtime_error("BenchHashMap: map returned wrong results");
+    }
+    result.bytesPerEntry = bytesPerEntry<HM>(keys, count, buckets);
+    return result;
+}
+
+void printSuiteResult(std::ostream& out, const BenchConfig& cfg, const std::string& map, KeyStream stream,
+                      double load, size_t count, const SuiteResult& r) {
+    const std::pair<const char*, const bench::LatencyHistogram*> ops[] = {
+        { "insert", &r.insert }, { "hit", &r.hit }, { "miss", &r.miss }, { "erase", &r.erase }, { "mixed", &r.mixed }
+    };
+    auto ns = [](const bench::LatencyHistogram& h, double p) { 
+        return static_cast<uint64_t>(bench::TscClock::toNs(h.percentile(p))); 
+    };
+    if (cfg.format == "csv") {
+        for (const auto& [op, h] : ops) {
+            out << map << "," << streamName(stream) << "," << load << "," << count << "," << op << "," 
+                << ns(*h, 50) << "," << ns(*h, 99) << "," << ns(*h, 99.9) << "," << r.bytesPerEntry << "\n";
+        }
+    }
+    else {
+        out << "\t" << map << ":";
+        for (const auto& [op, h] : ops) {
+            out << " " << op << " " << ns(*h, 50) << "/" << ns(*h, 99) << "/" << ns(*h, 99.9);
+        }
+        out << " ns, " << r.bytesPerEntry << " B/entry\n";
+    }
+}
+
+template <template <typename, typename, typename> class Map, typename K>
+void benchSuiteMap(std::ostream& out, const BenchConfig& cfg, const std::string& map, KeyStream stream,
+                   const std::vector<K>& keys, size_t buckets, double load) {
+    const size_t count = keys.size() / 2;
+    printSuiteResult(out, cfg, map, stream, load, count, benchOps<Map<K, uint64_t, std::hash<K>>>(keys, count, buckets));
+}
+
+void benchSuite(std::ostream& out, const BenchConfig& cfg) {
+    for (KeyStream stream : { KeyStream::Sequential, KeyStream::Random, KeyStream::TradeId, KeyStream::Symbol }) {
+        const size_t buckets = (stream == KeyStream::Symbol) ? cfg.symbolBuckets : cfg.buckets;
+        for (double load : { 0.25, 0.5, 0.7, 0.85 }) {
+            const size_t count = std::max<size_t>(1, static_cast<size_t>(buckets * load));
+            if (cfg.format != "csv") {
+                out << streamName(stream) << " keys, load " << load << " (" << count << " keys in " << buckets
+                    << " buckets), ns p50/p99/p99.9\n";
+            }
+            if (stream == KeyStream::Symbol) {
+                const std::vector<std::string> keys = makeSymbols(2 * count);
+                benchSuiteMap<ChainingHashMap>(out, cfg, "ChainingHashMap", stream, keys, buckets, load);
+                benchSuiteMap<FixedSizedChainingHashMap>(out, cfg, "FixedSizedChainingHashMap", stream, keys, buckets, load);
+                benchSuiteMap<OpenAddressingHashMap>(out, cfg, "OpenAddressingHashMap", stream, keys, buckets, load);
+                benchSuiteMap<SwissHashMap>(out, cfg, "SwissHashMap", stream, keys, buckets, load);
+                benchSuiteMap<RobinHoodHashMap>(out, cfg, "RobinHoodHashMap", stream, keys, buckets, load);
+                benchSuiteMap<DenseHashMap>(out, cfg, "DenseHashMap", stream, keys, buckets, load);
+                benchSuiteMap<STLHashMap>(out, cfg, "STLHashMap", stream, keys, buckets, load);
+                continue;
+            }
+            const std::vector<uint64_t> keys = makeStream(stream, 2 * count, cfg);
+            benchSuiteMap<ChainingHashMap>(out, cfg, "ChainingHashMap", stream, keys, buckets, load);
+            benchSuiteMap<FixedSizedChainingHashMap>(out, cfg, "FixedSizedChainingHashMap", stream, keys, buckets, load);
+            benchSuiteMap<OpenAddressingHashMap>(out, cfg, "OpenAddressingHashMap", stream, keys, buckets, load);
+            benchSuiteMap<SwissHashMap>(out, cfg, "SwissHashMap", stream, keys, buckets, load);
+            benchSuiteMap<RobinHoodHashMap>(out, cfg, "RobinHoodHashMap", stream, keys, buckets, load);
+            benchSuiteMap<DenseHashMap>(out, cfg, "DenseHashMap", stream, keys, buckets, load);
+            benchSuiteMap<ConcurrentHashMap>(out, cfg, "ConcurrentHashMap", stream, keys, buckets, load);
+            benchSuiteMap<STLHashMap>(out, cfg, "STLHashMap", stream, keys, buckets, load);
+        }
+    }
+}
+
+/**************************************************************************/
+template <typename HM, typename... Args>
+void benchGrowth(std::ostream& out, const BenchConfig& cfg, const std::string& map, Args&&... mapArgs) {
+    auto hm = std::make_unique<HashMap<HM>>(std::forward<Args>(mapArgs)...);
+    bench::LatencyHistogram latency;    // TSC ticks per insert
+    const uint64_t begin = bench::rdtsc();
+    for (uint64_t key = 0; key < cfg.growthKeys; ++key) {
+        const uint64_t start = bench::rdtsc();
+        hm->insert(key, key);
+        latency.record(bench::rdtsc() - start);
+    }
+    const double nsPerInsert = bench::TscClock::toNs(bench::rdtsc() - begin) / cfg.growthKeys;
+    auto ns = [&](double p) { return bench::TscClock::toNs(latency.percentile(p)); };
+    if (cfg.format == "csv") {
+        out << map << ",growth," << cfg.growthKeys << "," << nsPerInsert << "," << ns(50) << "," << ns(99.99) << ","
+            << bench::TscClock::toNs(latency.max()) << "\n";
+    }
+    else {
+        out << "\t" << map << " growth: " << nsPerInsert << " ns/insert, p50 " << ns(50) << " ns, p99.99 " 
+            << ns(99.99) << " ns, max " << bench::TscClock::toNs(latency.max()) / 1e3 << " us\n";
+    }
+}
+
+/**************************************************************************/
+template <typename HM>
+void benchIntervals(std::ostream& out, const BenchConfig& cfg, const std::string& map) {
+    constexpr size_t intervals = 2000;
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < cfg.symbols; ++i) {
+        symbols.push_back("SYM" + std::to_string(i));
+    }
+    std::mt19937_64 rng(42);
+    std::vector<uint32_t> trades(cfg.tradesPerInterval * intervals);
+    for (auto& symbol : trades) {
+        symbol = static_cast<uint32_t>(rng() % cfg.symbols);
+    }
+    auto hm = std::make_unique<HashMap<HM>>(std::bit_ceil(cfg.symbols * 2));
+    uint64_t aggregateTicks = 0, flushTicks = 0;
+    double total = 0;
+    for (size_t interval = 0; interval < intervals; ++interval) {
+        uint64_t start = bench::rdtsc();
+        for (size_t t = interval * cfg.tradesPerInterval; t < (interval + 1) * cfg.tradesPerInterval; ++t) {
+            auto& [notional, quantity] = (*hm)[symbols[trades[t]]];
+            notional += 100.0;
+            quantity += 1.0;
+        }
+        const uint64_t mid = bench::rdtsc();
+        for (const auto& [symbol, value] : *hm) {
+            total += value.first / value.second;
+        }
+        hm->clear();
+        const uint64_t end = bench::rdtsc();
+        aggregateTicks += mid - start;
+        flushTicks += end - mid;
+    }
+    const double tradeNs = bench::TscClock::toNs(aggregateTicks) / (intervals * cfg.tradesPerInterval);
+    const double flushNs = bench::TscClock::toNs(flushTicks) / intervals;
+    if (cfg.format == "csv") {
+        out << map << ",intervals," << cfg.symbols << "," << tradeNs << "," << flushNs << "\n";
+    }
+    else {
+        out << "\t" << map << " intervals: " << tradeNs << " ns/trade, " << flushNs << " ns per iterate+clear"
+            << (total > 0 ? "" : " (no output)") << "\n";
+    }
+}
+
+/**************************************************************************/
+struct SymbolState {
+    double lastPrice;
+    double volume;
+};
+
+// The baseline a shared map usually starts as: every operation under one mutex
+class LockedSTLHashMap {
+public:
+    explicit LockedSTLHashMap(size_t buckets) : map_(buckets) { }
+    bool load(uint64_t key, SymbolState& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SymbolState* state = map_.find(key);
+        if (state != nullptr) out = *state;
+        return state != nullptr;
+    }
+    template <typename F>
+    void update(uint64_t key, F&& f) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        f(map_[key]);
+    }
+private:
+    std::mutex mutex_;
+    STLHashMap<uint64_t, SymbolState> map_;
+};
+
+template <typename Map>
+void benchConcurrent(std::ostream& out, const BenchConfig& cfg, const std::string& map) {
+    for (size_t threads = 1; threads <= cfg.maxThreads; threads *= 2) {
+        Map hm(std::bit_ceil(cfg.symbols * 2));
+        for (uint64_t symbol = 0; symbol < cfg.symbols; ++symbol) {
+            hm.update(symbol, [](SymbolState& state) { state = SymbolState{ 100.0, 0.0 }; });
+        }
+        std::atomic<size_t> ready{ 0 };
+        std::atomic<uint64_t> found{ 0 };
+        std::vector<std::thread> workers;
+        const uint64_t start = bench::rdtsc();
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                bench::pinThread(static_cast<int>(t));
+                std::mt19937_64 rng(t);
+                ready.fetch_add(1);
+                while (ready.load() < threads) bench::cpuRelax();
+                uint64_t hits = 0;
+                SymbolState state;
+                for (size_t i = 0; i < cfg.concurrentOps; ++i) {
+                    const uint64_t r = rng();
+                    const uint64_t symbol = (r >> 8) % cfg.symbols;
+                    if (r % 100 < cfg.writePct) {
+                        hm.update(symbol, [](SymbolState& s) { s.lastPrice += 0.01; s.volume += 1.0; });
+                    }
+                    else {
+                        hits += hm.load(symbol, state) ? 1 : 0;
+                    }
+                }
+                found.fetch_add(hits);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        const double seconds = bench::TscClock::toNs(bench::rdtsc() - start) / 1e9;
+        const double mops = threads * cfg.concurrentOps / seconds / 1e6;
+        if (cfg.format == "csv") {
+            out << map << ",concurrent," << threads << "," << cfg.writePct << "," << mops << "\n";
+        }
+        else {
+            out << "\t" << map << " " << threads << "T: " << mops << " Mops/s" 
+                << (found.load() > 0 ? "" : " (no hits)") << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+        if (key == "--runs") cfg.runs = value;
+        else if (key == "--buckets") cfg.buckets = std::bit_ceil(std::max<size_t>(4, std::stoull(value)));
+        else if (key == "--symbol-buckets") cfg.symbolBuckets = std::bit_ceil(std::max<size_t>(4, std::stoull(value)));
+        else if (key == "--trades-dir") cfg.tradesDir = value;
+        else if (key == "--keys") cfg.keys = std::max<size_t>(1, std::stoull(value));
+        else if (key == "--stride") cfg.stride = std::max<uint64_t>(1, std::stoull(value));
+        else if (key == "--growth-keys") cfg.growthKeys = std::max<size_t>(1, std::stoull(value));
+        else if (key == "--symbols") cfg.symbols = std::max<size_t>(1, std::stoull(value));
+        else if (key == "--trades-per-interval") cfg.tradesPerInterval = std::max<size_t>(1, std::stoull(value));
+        else if (key == "--max-threads") cfg.maxThreads = std::max<size_t>(1, std::stoull(value));
+        else if (key == "--write-pct") cfg.writePct = std::min<size_t>(100, std::stoull(value));
+        else if (key == "--format") cfg.format = value;
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    // Results go to stdout through out; the maps' banners are discarded, the suite builds hundreds of them
+    std::ostream out(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);
+    auto runs = [&cfg](const std::string& run) { 
+        return ("," + cfg.runs + ",").find("," + run + ",") != std::string::npos; 
+    };
+
+    bench::TscClock::nsPerTick();   // calibrate before the first run
+    if (runs("suite")) {
+        if (cfg.format == "csv") {
+            out << "map,stream,load,keys,op,p50_ns,p99_ns,p999_ns,bytes_per_entry\n";
+        }
+        else {
+            out << "HashMap suite: " << cfg.buckets << " buckets, " << cfg.symbolBuckets << " for symbols, trade ids "
+                << (cfg.tradesDir.empty() ? "synthetic" : "from " + cfg.tradesDir) << ", timer overhead "
+                << bench::TscClock::toNs(bench::timerOverhead()) << " ns removed\n";
+        }
+        benchSuite(out, cfg);
+    }
+
+    if (runs("hashers")) {
+        if (cfg.format == "csv") {
+            out << "map,hasher,pattern,keys,insert_ns,hit_ns,miss_ns,erase_ns\n";
+        }
+        else {
+            out << "Hashers: " << cfg.keys << " keys, stride " << cfg.stride << ", " << Const::initBuckets
+                << " initial buckets\n";
+        }
+        benchHashers<ChainingHashMap>(out, cfg, "ChainingHashMap");
+        benchHashers<FixedSizedChainingHashMap>(out, cfg, "FixedSizedChainingHashMap");
+        benchHashers<OpenAddressingHashMap>(out, cfg, "OpenAddressingHashMap");
+        benchHashers<SwissHashMap>(out, cfg, "SwissHashMap");
+        benchHashers<RobinHoodHashMap>(out, cfg, "RobinHoodHashMap");
+        benchHashers<STLHashMap>(out, cfg, "STLHashMap");
+    }
+
+    if (runs("intervals")) {
+        if (cfg.format == "csv") {
+            out << "map,scenario,symbols,ns_per_trade,ns_per_flush\n";
+        }
+        else {
+            out << "Aggregation intervals of " << cfg.tradesPerInterval << " trades over " << cfg.symbols << " symbols\n";
+        }
+        benchIntervals<DenseHashMap<std::string, std::pair<double, double>>>(out, cfg, "DenseHashMap");
+        benchIntervals<STLHashMap<std::string, std::pair<double, double>>>(out, cfg, "STLHashMap");
+    }
+
+    if (runs("concurrent")) {
+        if (cfg.format == "csv") {
+            out << "map,scenario,threads,write_pct,mops\n";
+        }
+        else {
+            out << "Shared map, " << cfg.symbols << " symbols, " << cfg.writePct << "% writes\n";
+        }
+        benchConcurrent<ConcurrentHashMap<uint64_t, SymbolState>>(out, cfg, "ConcurrentHashMap");
+        benchConcurrent<LockedSTLHashMap>(out, cfg, "mutex+STLHashMap");
+    }
+
+    if (runs("growth")) {
+        if (cfg.format == "csv") {
+            out << "map,scenario,keys,ns_per_insert,p50_ns,p9999_ns,max_ns\n";
+        }
+        else {
+            out << "Growth from 1024 buckets to " << cfg.growthKeys << " keys\n";
+        }
+        benchGrowth<OpenAddressingHashMap<uint64_t, uint64_t>>(out, cfg, "OpenAddressingHashMap", 1024);
+        benchGrowth<OpenAddressingHashMap<uint64_t, uint64_t>>(out, cfg, "OpenAddressingHashMap(incremental)", 1024, true);
+        benchGrowth<SwissHashMap<uint64_t, uint64_t>>(out, cfg, "SwissHashMap", 1024);
+        benchGrowth<RobinHoodHashMap<uint64_t, uint64_t>>(out, cfg, "RobinHoodHashMap", 1024);
+    }
+
+    return 0;
+}
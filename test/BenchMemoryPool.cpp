@@ -0,0 +1,299 @@
+/*
+$ g++ -std=c++20 -O3 -o BenchMemoryPool BenchMemoryPool.cpp -I../include -I..
+$ ./BenchMemoryPool [--ops=200000] [--max-threads=32] [--window=256] [--pool-size=1048576]
+                    [--cpu=0] [--format=text|csv|json]
+
+Times every allocate and deallocate with the TSC and reports wall ns per allocation
+(timing included) and per-op percentiles (timer overhead removed) for three
+patterns, each with 1, 2, 4 ... --max-threads pinned threads:
+    churn   - every thread allocates and immediately frees
+    random  - every thread keeps --window live messages and frees a random one
+              before each allocation, so lifetimes are random and the free order
+              is unrelated to the allocation order
+    xthread - threads are paired, one allocates and sends over an SPSC queue, the
+              other frees, like the receiver and the DB writer
+malloc/free is included as the baseline, FollyIndexedMemPool with -DUSE_FOLLY_MEM_POOL.
+*/
+
+#include "MemoryPool.hpp"
+#include "Queue.hpp"
+#include "BenchUtils.hpp"
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdlib>
+
+struct alignas(64) BenchMsg {
+    uint64_t words[8];
+};
+
+struct BenchConfig {
+    size_t ops = 200'000;           // allocations per thread
+    size_t maxThreads = 32;
+    size_t window = 256;            // live messages per thread in the random pattern
+    size_t poolSize = 1 << 20;      // slots, SegmentedPool starts with this many
+    int cpu = 0;                    // first cpu, threads are pinned to consecutive cpus
+    std::string format = "text";
+};
+
+struct BenchResult {
+    std::string pool;
+    std::string scenario;
+    size_t threads = 0;
+    size_t ops = 0;                 // allocations, every one is also freed
+    double seconds = 0;
+    bench::LatencyHistogram allocLatency;   // TSC ticks per allocate, timer overhead removed
+    bench::LatencyHistogram freeLatency;    // TSC ticks per deallocate, timer overhead removed
+};
+
+inline uint64_t toNs(uint64_t ticks) {
+    return static_cast<uint64_t>(bench::TscClock::toNs(ticks));
+}
+
+// malloc/free behind the pool interface, the baseline every pool has to beat
+template <typename Msg>
+class MallocPool {
+public:
+    using MsgPtr = Msg*;
+    MsgPtr allocate() { return static_cast<MsgPtr>(std::aligned_alloc(alignof(Msg), sizeof(Msg))); }
+    void deallocate(MsgPtr msg) { std::free(msg); }
+    size_t allocate_bulk(size_t n, MsgPtr* out) {
+        for (size_t i = 0; i < n; ++i) out[i] = allocate();
+        return n;
+    }
+    void deallocate_bulk(std::span<const MsgPtr> msgs) {
+        for (MsgPtr msg : msgs) deallocate(msg);
+    }
+};
+
+template <typename P>
+std::unique_ptr<MemoryPool<P>> makePool(size_t poolSize) {
+    if constexpr (requires { P::slabSlots; }) {
+        return std::make_unique<MemoryPool<P>>(std::max<size_t>(1, poolSize / P::slabSlots));
+    }
+    else if constexpr (std::constructible_from<P, size_t>) {
+        return std::make_unique<MemoryPool<P>>(poolSize);
+    }
+    else {
+        return std::make_unique<MemoryPool<P>>();
+    }
+}
+
+// Runs body(threadId, result) on numThreads pinned threads after a common start signal
+template <typename Body>
+void runThreads(BenchResult& result, const BenchConfig& cfg, size_t numThreads, Body&& body) {
+    std::vector<BenchResult> perThread(numThreads);
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            bench::pinThread(cfg.cpu + static_cast<int>(t));
+            while (!go.load(std::memory_order_acquire)) bench::cpuRelax();
+            body(t, perThread[t]);
+        });
+    }
+    const uint64_t start = bench::rdtsc();
+    go.store(true, std::memory_order_release);
+    for (auto& thr : threads) {
+        thr.join();
+    }
+    result.seconds = bench::TscClock::toNs(bench::rdtsc() - start) / 1e9;
+    for (const auto& r : perThread) {
+        result.ops += r.ops;
+        result.allocLatency.merge(r.allocLatency);
+        result.freeLatency.merge(r.freeLatency);
+    }
+}
+
+template <typename Pool>
+inline BenchMsg* timedAllocate(Pool& pool, BenchResult& r) {
+    const uint64_t start = bench::rdtsc();
+    BenchMsg* msg = pool.allocate();
+    bench::recordTicks(r.allocLatency, start, bench::rdtsc());
+    return msg;
+}
+
+template <typename Pool>
+inline void timedDeallocate(Pool& pool, BenchMsg* msg, BenchResult& r) {
+    const uint64_t start = bench::rdtsc();
+    pool.deallocate(msg);
+    bench::recordTicks(r.freeLatency, start, bench::rdtsc());
+}
+
+/**************************************************************************/
+template <typename P>
+BenchResult churn(const std::string& poolType, const BenchConfig& cfg, size_t numThreads) {
+    BenchResult result{ poolType, "churn", numThreads, 0, 0, {}, {} };
+    auto pool = makePool<P>(cfg.poolSize);
+    runThreads(result, cfg, numThreads, [&](size_t t, BenchResult& r) {
+        for (size_t i = 0; i < cfg.ops; ++i) {
+            BenchMsg* msg = timedAllocate(*pool, r);
+            if (msg == nullptr) break;
+            msg->words[0] = t + i;
+            timedDeallocate(*pool, msg, r);
+            ++r.ops;
+        }
+    });
+    return result;
+}
+
+/**************************************************************************/
+template <typename P>
+BenchResult randomLifetimes(const std::string& poolType, const BenchConfig& cfg, size_t numThreads) {
+    BenchResult result{ poolType, "random", numThreads, 0, 0, {}, {} };
+    auto pool = makePool<P>(cfg.poolSize);
+    runThreads(result, cfg, numThreads, [&](size_t t, BenchResult& r) {
+        std::vector<BenchMsg*> live(cfg.window, nullptr);
+        uint64_t rng = 0x9E3779B97F4A7C15ull * (t + 1);
+        for (size_t i = 0; i < cfg.ops; ++i) {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+            BenchMsg*& slot = live[rng % cfg.window];
+            if (slot != nullptr) {
+                timedDeallocate(*pool, slot, r);
+            }
+            slot = timedAllocate(*pool, r);
+            if (slot == nullptr) break;
+            slot->words[0] = i;
+            ++r.ops;
+        }
+        for (BenchMsg* msg : live) {
+            if (msg != nullptr) pool->deallocate(msg);
+        }
+    });
+    return result;
+}
+
+/**************************************************************************/
+template <typename P>
+BenchResult crossThread(const std::string& poolType, const BenchConfig& cfg, size_t numThreads) {
+    BenchResult result{ poolType, "xthread", numThreads, 0, 0, {}, {} };
+    auto pool = makePool<P>(cfg.poolSize);
+    const size_t pairs = numThreads / 2;
+    std::vector<std::unique_ptr<CustomSPSCLockFreeQueue<BenchMsg*>>> queues;
+    for (size_t i = 0; i < pairs; ++i) {
+        queues.push_back(std::make_unique<CustomSPSCLockFreeQueue<BenchMsg*>>(1 << 12, PageOptions{ PageSize::Default4K }));
+    }
+    runThreads(result, cfg, pairs * 2, [&](size_t t, BenchResult& r) {
+        auto& queue = *queues[t / 2];
+        bench::Backoff backoff;
+        if (t % 2 == 0) {
+            for (size_t i = 0; i < cfg.ops; ++i) {
+                BenchMsg* msg = nullptr;
+                while ((msg = timedAllocate(*pool, r)) == nullptr) backoff.pause();   // rest is in flight
+                msg->words[0] = i;
+                while (!queue.enqueue(msg)) backoff.pause();
+                backoff.reset();
+                ++r.ops;
+            }
+        }
+        else {
+            for (size_t i = 0; i < cfg.ops; ++i) {
+                BenchMsg* msg = nullptr;
+                while ((msg = queue.dequeue()) == nullptr) backoff.pause();
+                backoff.reset();
+                timedDeallocate(*pool, msg, r);
+            }
+        }
+    });
+    return result;
+}
+
+/**************************************************************************/
+void printHeader(std::ostream& out, const BenchConfig& cfg) {
+    if (cfg.format == "csv") {
+        out << "pool,scenario,threads,ops,seconds,ns_per_op,alloc_p50_ns,alloc_p99_ns,alloc_p999_ns,alloc_max_ns,"
+               "free_p50_ns,free_p99_ns,free_p999_ns,free_max_ns\n";
+    }
+    else if (cfg.format == "json") {
+        out << "[\n";
+    }
+    else {
+        out << "Pool benchmark: " << cfg.ops << " allocations per thread, up to " << cfg.maxThreads
+            << " threads, window " << cfg.window << ", pool size " << cfg.poolSize << ", cpus from " << cfg.cpu 
+            << ", timer overhead " << toNs(bench::timerOverhead()) << " ns removed from percentiles\n";
+    }
+}
+
+void printResult(std::ostream& out, const BenchConfig& cfg, const BenchResult& r, bool first) {
+    // Wall time per allocate+free pair per thread that allocates
+    const size_t allocators = (r.scenario == "xthread") ? r.threads / 2 : r.threads;
+    const double nsPerOp = r.seconds * 1e9 * allocators / std::max<size_t>(1, r.ops);
+    const auto& a = r.allocLatency;
+    const auto& f = r.freeLatency;
+    auto ns = [](const bench::LatencyHistogram& h, double p) { return toNs(h.percentile(p)); };
+    if (cfg.format == "csv") {
+        out << r.pool << "," << r.scenario << "," << r.threads << "," << r.ops << "," << r.seconds << "," << nsPerOp
+            << "," << ns(a, 50) << "," << ns(a, 99) << "," << ns(a, 99.9) << "," << toNs(a.max())
+            << "," << ns(f, 50) << "," << ns(f, 99) << "," << ns(f, 99.9) << "," << toNs(f.max()) << "\n";
+    }
+    else if (cfg.format == "json") {
+        out << (first ? "" : ",\n") << "  {\"pool\": \"" << r.pool << "\", \"scenario\": \"" << r.scenario
+            << "\", \"threads\": " << r.threads << ", \"ops\": " << r.ops << ", \"seconds\": " << r.seconds
+            << ", \"ns_per_op\": " << nsPerOp
+            << ", \"alloc_p50_ns\": " << ns(a, 50) << ", \"alloc_p99_ns\": " << ns(a, 99)
+            << ", \"alloc_p999_ns\": " << ns(a, 99.9) << ", \"alloc_max_ns\": " << toNs(a.max())
+            << ", \"free_p50_ns\": " << ns(f, 50) << ", \"free_p99_ns\": " << ns(f, 99)
+            << ", \"free_p999_ns\": " << ns(f, 99.9) << ", \"free_max_ns\": " << toNs(f.max()) << "}";
+    }
+    else {
+        out << "\t" << r.pool << " " << r.scenario << " " << r.threads << "T: " << nsPerOp << " ns/op, alloc p50 "
+            << ns(a, 50) << " p99 " << ns(a, 99) << " max " << toNs(a.max()) << " ns, free p50 "
+            << ns(f, 50) << " p99 " << ns(f, 99) << " max " << toNs(f.max()) << " ns\n";
+    }
+}
+
+template <typename P>
+void benchPool(std::ostream& out, const std::string& poolType, const BenchConfig& cfg, bool& first) {
+    auto emit = [&](const BenchResult& r) { printResult(out, cfg, r, first); first = false; };
+    for (size_t threads = 1; threads <= cfg.maxThreads; threads *= 2) {
+        emit(churn<P>(poolType, cfg, threads));
+        emit(randomLifetimes<P>(poolType, cfg, threads));
+        if (threads >= 2) {
+            emit(crossThread<P>(poolType, cfg, threads));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+        if (key == "--ops") cfg.ops = std::stoull(value);
+        else if (key == "--max-threads") cfg.maxThreads = std::stoull(value);
+        else if (key == "--window") cfg.window = std::max<size_t>(1, std::stoull(value));
+        else if (key == "--pool-size") cfg.poolSize = std::stoull(value);
+        else if (key == "--cpu") cfg.cpu = std::stoi(value);
+        else if (key == "--format") cfg.format = value;
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    // Results go to stdout through out; for csv/json the pools' banners are discarded
+    std::ostream out(std::cout.rdbuf());
+    if (cfg.format != "text") {
+        std::cout.rdbuf(nullptr);
+    }
+
+    bench::TscClock::nsPerTick();   // calibrate before the first run
+    bool first = true;
+    printHeader(out, cfg);
+    benchPool<MallocPool<BenchMsg>>(out, "malloc", cfg, first);
+    benchPool<BoostPool<BenchMsg, true>>(out, "BoostPool", cfg, first);
+    benchPool<CustomLockedPool<BenchMsg, true>>(out, "CustomLockedPool", cfg, first);
+    benchPool<CustomLockFreePool<BenchMsg, true>>(out, "CustomLockFreePool", cfg, first);
+    benchPool<LockFreeThreadSafePool<BenchMsg, true>>(out, "LockFreeThreadSafePool", cfg, first);
+    benchPool<LockFreeThreadSafePool<BenchMsg, true, 64>>(out, "LockFreeThreadSafePool<64>", cfg, first);
+    benchPool<SegmentedPool<BenchMsg>>(out, "SegmentedPool", cfg, first);
+#ifdef USE_FOLLY_MEM_POOL
+    benchPool<FollyIndexedMemPool<BenchMsg, true>>(out, "FollyIndexedMemPool", cfg, first);
+#endif
+    if (cfg.format == "json") out << "\n]\n";
+
+    return 0;
+}
@@ -0,0 +1,336 @@
+/*
+$ g++ -std=c++20 -O3 -o BenchQueue BenchQueue.cpp -I../include -I..
+$ ./BenchQueue [--msgs=500000] [--round-trips=200000] [--threads=2] [--payload=64] [--burst=0]
+               [--gap-ns=0] [--capacity=16384] [--cpu=0] [--format=text|csv|json]
+
+For every queue type runs a cross-core ping-pong (round-trip latency) followed by a
+1P1C, 1PnC, nP1C and nPnC throughput run (n = --threads) that also records one-way
+enqueue-to-dequeue latency. Combinations a queue does not support (e.g. several
+producers on an SPSC queue) are skipped. Use --format=csv or --format=json to keep
+results across commits.
+*/
+
+#include "Queue.hpp"
+#include "BenchUtils.hpp"
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+
+struct BenchConfig {
+    size_t msgs = 500'000;          // per throughput run, split across producers
+    size_t roundTrips = 200'000;
+    size_t threads = 2;             // n in 1PnC, nP1C and nPnC
+    size_t payload = 64;            // bytes written by the producer and read by the consumer
+    size_t burst = 0;               // messages per burst, 0 sends back to back
+    uint64_t gapNs = 0;             // pause between bursts
+    size_t capacity = 1 << 14;
+    int cpu = 0;                    // first cpu, threads are pinned to consecutive cpus
+    std::string format = "text";
+};
+
+struct BenchResult {
+    std::string queue;
+    std::string scenario;
+    size_t producers = 0;
+    size_t consumers = 0;
+    size_t msgs = 0;
+    double seconds = 0;
+    double cacheMissesPerMsg = -1;  // -1 when perf events are unavailable
+    bench::LatencyHistogram latency; // ns, round trip for RTT and one-way otherwise
+};
+
+// Every message starts with this header, the rest of the payload is filler the consumer reads
+struct MsgHeader {
+    uint64_t stamp;
+    uint64_t seq;
+};
+
+template <typename Q>
+std::unique_ptr<Queue<Q>> makeQueue(size_t capacity) {
+    if constexpr (std::constructible_from<Q, size_t>) return std::make_unique<Queue<Q>>(capacity);
+    else return std::make_unique<Queue<Q>>();  // LockedQueue is unbounded
+}
+
+template <typename Q>
+constexpr bool blockingDequeue = false;
+template <typename T>
+constexpr bool blockingDequeue<LockedQueue<T>> = true;   // needs a nullptr sentinel per consumer to stop
+
+/**************************************************************************
+Cross-core ping-pong: the ping thread sends a token on one queue and waits for it
+to come back on a second queue, so every round trip moves the index cache lines
+of both queues between the two cores.
+**************************************************************************/
+template <typename Q>
+BenchResult pingPong(const std::string& queueType, const BenchConfig& cfg) {
+    BenchResult result{ queueType, "RTT", 1, 1, cfg.roundTrips, 0, -1, {} };
+    auto pingQ = makeQueue<Q>(cfg.capacity);
+    auto pongQ = makeQueue<Q>(cfg.capacity);
+    std::vector<char> tokens(cfg.roundTrips);
+
+    bench::CacheMissCounter cacheMisses;
+    cacheMisses.start();
+
+    std::thread pong([&]() {
+        bench::pinThread(cfg.cpu + 1);
+        bench::Backoff backoff;
+        for (size_t i = 0; i < cfg.roundTrips; ++i) {
+            char* token = nullptr;
+            while ((token = pingQ->dequeue()) == nullptr)
+                backoff.pause();
+            backoff.reset();
+            while (!pongQ->enqueue(token))
+                backoff.pause();
+        }
+    });
+
+    bench::pinThread(cfg.cpu);
+    bench::Backoff backoff;
+    const uint64_t start = bench::rdtsc();
+    for (size_t i = 0; i < cfg.roundTrips; ++i) {
+        const uint64_t sent = bench::rdtsc();
+        while (!pingQ->enqueue(&tokens[i]))
+            backoff.pause();
+        char* token = nullptr;
+        while ((token = pongQ->dequeue()) == nullptr)
+            backoff.pause();
+        backoff.reset();
+        result.latency.record(static_cast<uint64_t>(bench::TscClock::toNs(bench::rdtsc() - sent)));
+        if (token != &tokens[i]) {
+            std::cerr << "\tOut of order token at round trip " << i << "\n";
+        }
+    }
+    const uint64_t end = bench::rdtsc();
+    pong.join();
+    const uint64_t misses = cacheMisses.stop();
+
+    result.seconds = bench::TscClock::toNs(end - start) / 1e9;
+    if (cacheMisses.valid()) result.cacheMissesPerMsg = static_cast<double>(misses) / cfg.roundTrips;
+    return result;
+}
+
+/**************************************************************************
+Producers stamp each message with the TSC and send it in bursts, consumers read
+the whole payload and record the one-way latency. Every message has its own
+payload slot, never rewritten during the run, so no queue (LockedQueue is
+unbounded) lets a producer overwrite a stamp a consumer has yet to read.
+The slots are zeroed, and so faulted in, before the clock starts.
+**************************************************************************/
+template <typename Q>
+BenchResult throughput(const std::string& queueType, const BenchConfig& cfg,
+                       size_t producers, size_t consumers) {
+    const std::string scenario = std::to_string(producers) + "P" + std::to_string(consumers) + "C";
+    BenchResult result{ queueType, scenario, producers, consumers, 0, 0, -1, {} };
+    auto queue = makeQueue<Q>(cfg.capacity);
+
+    const size_t perProducer = cfg.msgs / producers;
+    const size_t total = perProducer * producers;
+    const size_t stride = (std::max(cfg.payload, sizeof(MsgHeader)) + 63) & ~size_t(63);
+    std::vector<std::vector<char>> slabs(producers, std::vector<char>(perProducer * stride + 64));
+    std::vector<bench::LatencyHistogram> histograms(consumers);
+    std::vector<size_t> consumed(consumers, 0);
+    std::atomic<bool> producersDone{ false };
+    std::atomic<bool> go{ false };
+    std::atomic<uint64_t> sink{ 0 };
+    const double ticksPerNs = 1.0 / bench::TscClock::nsPerTick();
+    const uint64_t gapTicks = static_cast<uint64_t>(cfg.gapNs * ticksPerNs);
+
+    bench::CacheMissCounter cacheMisses;
+    cacheMisses.start();
+
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            bench::pinThread(cfg.cpu + static_cast<int>(producers + c));
+            bench::Backoff backoff;
+            bench::LatencyHistogram& histogram = histograms[c];
+            uint64_t checksum = 0;
+            size_t count = 0;
+            while (true) {
+                char* msg = queue->dequeue();
+                if (!msg) {
+                    if constexpr (blockingDequeue<Q>) break;   // sentinel
+                    if (producersDone.load(std::memory_order_acquire) && queue->empty()) break;
+                    backoff.pause();
+                    continue;
+                }
+                backoff.reset();
+                const uint64_t now = bench::rdtsc();
+                const auto* header = reinterpret_cast<const MsgHeader*>(msg);
+                for (size_t i = sizeof(MsgHeader); i < cfg.payload; i += sizeof(uint64_t)) {
+                    uint64_t word;
+                    std::memcpy(&word, msg + i, sizeof(word));
+                    checksum += word;
+                }
+                checksum += header->seq;
+                histogram.record(static_cast<uint64_t>(bench::TscClock::toNs(now - header->stamp)));
+                ++count;
+            }
+            consumed[c] = count;
+            sink.fetch_add(checksum, std::memory_order_relaxed);
+        });
+    }
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            bench::pinThread(cfg.cpu + static_cast<int>(p));
+            bench::Backoff backoff;
+            char* slab = slabs[p].data() + (64 - reinterpret_cast<uintptr_t>(slabs[p].data()) % 64);
+            while (!go.load(std::memory_order_acquire)) bench::cpuRelax();
+            for (size_t seq = 0; seq < perProducer; ++seq) {
+                if (cfg.burst != 0 && seq != 0 && seq % cfg.burst == 0 && gapTicks != 0) {
+                    const uint64_t until = bench::rdtsc() + gapTicks;
+                    while (bench::rdtsc() < until) bench::cpuRelax();
+                }
+                char* msg = slab + seq * stride;
+                if (cfg.payload > sizeof(MsgHeader))
+                    std::memset(msg + sizeof(MsgHeader), static_cast<int>(seq), cfg.payload - sizeof(MsgHeader));
+                auto* header = reinterpret_cast<MsgHeader*>(msg);
+                header->seq = seq;
+                header->stamp = bench::rdtsc();
+                while (!queue->enqueue(msg))
+                    backoff.pause();
+                backoff.reset();
+            }
+        });
+    }
+
+    const uint64_t start = bench::rdtsc();
+    go.store(true, std::memory_order_release);
+    for (size_t p = 0; p < producers; ++p) {
+        threads[consumers + p].join();
+    }
+    producersDone.store(true, std::memory_order_release);
+    if constexpr (blockingDequeue<Q>) {
+        for (size_t c = 0; c < consumers; ++c) queue->enqueue(nullptr);
+    }
+    for (size_t c = 0; c < consumers; ++c) {
+        threads[c].join();
+    }
+    const uint64_t end = bench::rdtsc();
+    const uint64_t misses = cacheMisses.stop();
+
+    for (const auto& histogram : histograms) {
+        result.latency.merge(histogram);
+    }
+    for (size_t count : consumed) {
+        result.msgs += count;
+    }
+    if (result.msgs != total) {
+        std::cerr << "\t" << queueType << " " << scenario << " delivered " << result.msgs << " of " << total << " messages\n";
+    }
+    result.seconds = bench::TscClock::toNs(end - start) / 1e9;
+    if (cacheMisses.valid()) result.cacheMissesPerMsg = static_cast<double>(misses) / std::max<size_t>(1, total);
+    return result;
+}
+
+/**************************************************************************/
+void printHeader(std::ostream& out, const BenchConfig& cfg) {
+    if (cfg.format == "csv") {
+        out << "queue,scenario,producers,consumers,payload,burst,gap_ns,msgs,seconds,mops,"
+                     "p50_ns,p90_ns,p99_ns,p999_ns,max_ns,cache_misses_per_msg\n";
+    }
+    else if (cfg.format == "json") {
+        out << "[\n";
+    }
+    else {
+        out << "Queue benchmark: " << cfg.msgs << " msgs, " << cfg.roundTrips << " round trips, payload "
+                  << cfg.payload << "B, burst " << cfg.burst << " gap " << cfg.gapNs << "ns, capacity "
+                  << cfg.capacity << ", cpus from " << cfg.cpu << "\n";
+    }
+}
+
+void printResult(std::ostream& out, const BenchConfig& cfg, const BenchResult& r, bool first) {
+    const double mops = r.msgs / r.seconds / 1e6;
+    const auto& h = r.latency;
+    if (cfg.format == "csv") {
+        out << r.queue << "," << r.scenario << "," << r.producers << "," << r.consumers << ","
+                  << cfg.payload << "," << cfg.burst << "," << cfg.gapNs << "," << r.msgs << ","
+                  << r.seconds << "," << mops << "," << h.percentile(50) << "," << h.percentile(90) << ","
+                  << h.percentile(99) << "," << h.percentile(99.9) << "," << h.max() << ","
+                  << r.cacheMissesPerMsg << "\n";
+    }
+    else if (cfg.format == "json") {
+        out << (first ? "" : ",\n") << "  {\"queue\": \"" << r.queue << "\", \"scenario\": \"" << r.scenario
+                  << "\", \"producers\": " << r.producers << ", \"consumers\": " << r.consumers
+                  << ", \"payload\": " << cfg.payload << ", \"burst\": " << cfg.burst << ", \"gap_ns\": " << cfg.gapNs
+                  << ", \"msgs\": " << r.msgs << ", \"seconds\": " << r.seconds << ", \"mops\": " << mops
+                  << ", \"p50_ns\": " << h.percentile(50) << ", \"p90_ns\": " << h.percentile(90)
+                  << ", \"p99_ns\": " << h.percentile(99) << ", \"p999_ns\": " << h.percentile(99.9)
+                  << ", \"max_ns\": " << h.max() << ", \"cache_misses_per_msg\": " << r.cacheMissesPerMsg
+                  << ", \"histogram\": [";
+        bool firstBucket = true;
+        for (const auto& [upper, count] : h.buckets()) {
+            out << (firstBucket ? "" : ", ") << "[" << upper << ", " << count << "]";
+            firstBucket = false;
+        }
+        out << "]}";
+    }
+    else {
+        out << "\t" << r.queue << " " << r.scenario << ": " << mops << " Mmsg/s, "
+                  << (r.scenario == "RTT" ? "round trip" : "latency") << " p50 " << h.percentile(50)
+                  << " p99 " << h.percentile(99) << " p99.9 " << h.percentile(99.9) << " max " << h.max() << " ns";
+        if (r.cacheMissesPerMsg >= 0) out << ", " << r.cacheMissesPerMsg << " cache-misses/msg";
+        out << "\n";
+    }
+}
+
+template <typename Q>
+void benchQueue(std::ostream& out, const std::string& queueType, const BenchConfig& cfg, bool& first) {
+    auto emit = [&](const BenchResult& r) { printResult(out, cfg, r, first); first = false; };
+    emit(pingPong<Q>(queueType, cfg));
+    const size_t n = std::max<size_t>(1, cfg.threads);
+    const std::pair<size_t, size_t> matrix[] = { {1, 1}, {1, n}, {n, 1}, {n, n} };
+    for (size_t i = 0; i < std::size(matrix); ++i) {
+        const auto [producers, consumers] = matrix[i];
+        if (n == 1 && i > 0) break;
+        if (producers > 1 && !Q::multiProducer) continue;
+        if (consumers > 1 && !Q::multiConsumer) continue;
+        emit(throughput<Q>(queueType, cfg, producers, consumers));
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+        if (key == "--msgs") cfg.msgs = std::stoull(value);
+        else if (key == "--round-trips") cfg.roundTrips = std::stoull(value);
+        else if (key == "--threads") cfg.threads = std::stoull(value);
+        else if (key == "--payload") cfg.payload = std::stoull(value);
+        else if (key == "--burst") cfg.burst = std::stoull(value);
+        else if (key == "--gap-ns") cfg.gapNs = std::stoull(value);
+        else if (key == "--capacity") cfg.capacity = std::stoull(value);
+        else if (key == "--cpu") cfg.cpu = std::stoi(value);
+        else if (key == "--format") cfg.format = value;
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    // Results go to stdout through out; for csv/json the queues' "Using ..." banners are discarded
+    std::ostream out(std::cout.rdbuf());
+    if (cfg.format != "text") {
+        std::cout.rdbuf(nullptr);
+    }
+
+    bool first = true;
+    printHeader(out, cfg);
+    benchQueue<CustomCachedSPSCLockFreeQueue<char*>>(out, "CustomCachedSPSCLockFreeQueue", cfg, first);
+    benchQueue<CustomSPSCLockFreeQueue<char*>>(out, "CustomSPSCLockFreeQueue", cfg, first);
+    benchQueue<CustomMPMCLockFreeQueue<char*>>(out, "CustomMPMCLockFreeQueue", cfg, first);
+    benchQueue<BoostLockFreeQueue<char*>>(out, "BoostLockFreeQueue", cfg, first);
+    benchQueue<LockedQueue<char*>>(out, "LockedQueue", cfg, first);
+#ifdef USE_MOODYCAMEL_QUEUE
+    benchQueue<MoodycamelLockFreeQueue<char*>>(out, "MoodycamelLockFreeQueue", cfg, first);
+#endif
+    if (cfg.format == "json") out << "\n]\n";
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+// Helpers shared by the Bench*.cpp benchmarks: thread pinning, a calibrated TSC clock,
+// a latency histogram and a Linux hardware cache-miss counter.
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <array>
+#include <vector>
+#include <utility>
+#include <bit>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+// Pins the calling thread to cpu (modulo the number of online cores). Returns false if refused.
+inline bool pinThread(int cpu) {
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cores, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Busy-wait helper: pause for a while, then yield so oversubscribed runs still progress.
+struct Backoff {
+    uint32_t spins = 0;
+    void pause() {
+        if (++spins < 128) {
+            cpuRelax();
+        }
+        else {
+            std::this_thread::yield();
+            spins = 0;
+        }
+    }
+    void reset() { spins = 0; }
+};
+
+inline uint64_t rdtsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Converts TSC ticks to nanoseconds, calibrated once against steady_clock.
+class TscClock {
+public:
+    static double nsPerTick() {
+        static const double value = calibrate();
+        return value;
+    }
+    static double toNs(uint64_t ticks) { return ticks * nsPerTick(); }
+private:
+    static double calibrate() {
+        using namespace std::chrono;
+        const auto t0 = steady_clock::now();
+        const uint64_t c0 = rdtsc();
+        std::this_thread::sleep_for(milliseconds(50));
+        const uint64_t c1 = rdtsc();
+        const auto t1 = steady_clock::now();
+        return static_cast<double>(duration_cast<nanoseconds>(t1 - t0).count()) / (c1 - c0);
+    }
+};
+
+// Log-linear latency histogram: 16 linear sub-buckets per power of two, so any recorded
+// value is reported within ~6% of its true value. Recording is a couple of shifts and an
+// increment, cheap enough to keep one per thread on the hot path and merge afterwards.
+class LatencyHistogram {
+public:
+    static constexpr uint32_t SubBucketBits = 4;
+    static constexpr uint32_t SubBuckets = 1u << SubBucketBits;
+    static constexpr uint32_t NumBuckets = (64 - SubBucketBits + 1) * SubBuckets;
+
+    void record(uint64_t value) {
+        ++counts_[indexOf(value)];
+        ++total_;
+        max_ = std::max(max_, value);
+    }
+    void merge(const LatencyHistogram& other) {
+        for (uint32_t i = 0; i < NumBuckets; ++i) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+    // Upper bound of the bucket holding the p-th percentile (p in [0, 100])
+    uint64_t percentile(double p) const {
+        if (total_ == 0) return 0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * total_ + 0.5));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < NumBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(upperBound(i), max_);
+        }
+        return max_;
+    }
+    // Non-empty buckets as (upper bound, count) pairs
+    std::vector<std::pair<uint64_t, uint64_t>> buckets() const {
+        std::vector<std::pair<uint64_t, uint64_t>> out;
+        for (uint32_t i = 0; i < NumBuckets; ++i)
+            if (counts_[i] != 0) out.emplace_back(upperBound(i), counts_[i]);
+        return out;
+    }
+private:
+    static uint32_t indexOf(uint64_t value) {
+        if (value < SubBuckets) return static_cast<uint32_t>(value);
+        const uint32_t shift = 63 - std::countl_zero(value) - SubBucketBits;
+        return (shift << SubBucketBits) + static_cast<uint32_t>(value >> shift);
+    }
+    static uint64_t upperBound(uint32_t index) {
+        if (index < SubBuckets) return index;
+        const uint32_t shift = (index >> SubBucketBits) - 1;
+        const uint64_t sub = (index & (SubBuckets - 1)) | SubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+    std::array<uint64_t, NumBuckets> counts_{};
+    uint64_t total_ = 0;
+    uint64_t max_ = 0;
+};
+
+// Cheapest back-to-back rdtsc pair, measured once and taken off every per-op sample
+inline uint64_t timerOverhead() {
+    static const uint64_t overhead = [] {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 10'000; ++i) {
+            const uint64_t start = rdtsc();
+            best = std::min(best, rdtsc() - start);
+        }
+        return best;
+    }();
+    return overhead;
+}
+
+// Records the ticks from start to end with the timer overhead removed
+inline void recordTicks(LatencyHistogram& histogram, uint64_t start, uint64_t end) {
+    const uint64_t ticks = end - start;
+    histogram.record(ticks > timerOverhead() ? ticks - timerOverhead() : 0);
+}
+
+// Hardware cache-miss counter for this thread and every thread it spawns after start().
+// Falls back to valid() == false when perf events are unavailable (containers, paranoid level).
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMissCounter() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool valid() const { return fd_ >= 0; }
+    void start() {
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    // Call after the spawned threads have been joined so their counts are folded in
+    uint64_t stop() {
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (::read(fd_, &count, sizeof(count)) != sizeof(count))
+            return 0;
+        return count;
+    }
+private:
+    int fd_ = -1;
+};
+
+} // namespace bench
@@ -1,19 +1,35 @@
 // g++ -std=c++20 RunTradeReceiver.cpp -o RunTradeReceiver -I../include -DPOOL_MSG_COUNT=400000
+// Add -DPOOL_DEBUG (optionally with -fsanitize=address) to check every free and report leaked messages by stage
 
 #include "TradeReceiver.hpp"
 #include "DBManager.hpp"
+#include "QueueStatsSampler.hpp"
 
 const std::string connStr = "dbname=trades user=postgres password=postgres host=timescaledb";
 
-using MsgPool = LockFreeThreadSafePool<ITCHTradeMsg, true>;
+#ifdef POOL_DEBUG
+#include "DebugPool.hpp"
+using MsgPool = DebugPool<SegmentedPool<ITCHTradeMsg>>; // checks frees, dumps leaked messages by stage at exit
+#else
+using MsgPool = SegmentedPool<ITCHTradeMsg>; // grows by slabs during bursts instead of stopping the feed
+#endif
 using TradeReceiverToSequencerQ = CustomSPSCLockFreeQueue<ITCHTradeMsg*>;
-using SequencerToDownstreamQ = CustomSPSCLockFreeQueue<ITCHTradeMsg*>; // can use CustomMPMCLockFreeQueue as well
+using SequencerToDownstreamQ = WaitableQueue<CustomSPSCLockFreeQueue<ITCHTradeMsg*>>; // can use CustomMPMCLockFreeQueue as well
 
+// The sequencer is latency critical and keeps spinning, the DB writer parks when the market is idle
 using TradeDataSequencerT = TradeDataSequencer<ITCHTradeMsg, TradeReceiverToSequencerQ, 
-                                        SequencerToDownstreamQ, MsgPool>;
+                                        SequencerToDownstreamQ, MsgPool, BusySpinWait>;
 using MulticastTradeDataReceiverT = MulticastTradeDataReceiver<ITCHTradeMsg, 
                                         TradeReceiverToSequencerQ, MsgPool>;
-using DBManagerT = DBManager<ITCHTradeMsg, SequencerToDownstreamQ, MsgPool>;
+using DBManagerT = DBManager<ITCHTradeMsg, SequencerToDownstreamQ, MsgPool, true, AdaptiveWait>;
+
+// The sequencer drains the receiver queue on a spinning core, so it only has to absorb short bursts.
+// The DB writer commits in batches and can stall, so its queue is sized for much more backlog.
+constexpr size_t receiverToSequencerQCapacity = 1 << 16;
+constexpr size_t sequencerToDownstreamQCapacity = 1 << 18;
+// Start with enough slabs for the normal backlog, a background thread keeps spare ones ready for bursts
+constexpr size_t msgPoolInitialSlabs = 8;
+constexpr size_t msgPoolHeadroomSlabs = 2;
 
 /**************************************************************************/
 void runMarketDataReceiverToSequencerPipeline() {
@@ -22,19 +38,28 @@ void runMarketDataReceiverToSequencerPipeline() {
 
     logger.log("runMarketDataReceiverToSequencerPipeline Start\n");
 
-    TradeReceiverToSequencerQ tradeReceiverToSequencerQ;
-    SequencerToDownstreamQ downstreamQ;
-    MsgPool msgPool;
+    TradeReceiverToSequencerQ tradeReceiverToSequencerQ(receiverToSequencerQCapacity);
+    SequencerToDownstreamQ downstreamQ(sequencerToDownstreamQCapacity);
+    MsgPool msgPool(msgPoolInitialSlabs, msgPoolHeadroomSlabs);
 
     MulticastTradeDataReceiverT multicastTradeReceiver(tradeReceiverToSequencerQ, msgPool, logger);
     TradeDataSequencerT tradeSequencer(tradeReceiverToSequencerQ, downstreamQ, msgPool, logger);
     DBManagerT dbManager(connStr, downstreamQ, msgPool, logger);
 
+    QueueStatsSampler statsSampler(logger);
+    statsSampler.add("TradeReceiverToSequencerQ", tradeReceiverToSequencerQ);
+    statsSampler.add("SequencerToDownstreamQ", downstreamQ);
+    statsSampler.addCounter("MulticastTradeDataReceiver.dropped", [&] { return multicastTradeReceiver.droppedMsgs(); });
+    statsSampler.addCounter("TradeDataSequencer.dropped", [&] { return tradeSequencer.droppedMsgs(); });
+    statsSampler.addCounter("MsgPool.slabs", [&] { return msgPool.slabs(); });
+    statsSampler.addCounter("MsgPool.coldGrowths", [&] { return msgPool.coldGrowths(); });
+
     dbManager.connect();
     multicastTradeReceiver.connect();
     std::this_thread::sleep_for(std::chrono::seconds(1)); // Check for readiness using a different method, login msg?
 
     logger.log("Starting Threads for TradeDataSequencer and MulticastTradeDataReceiver\n");
+    statsSampler.start();
 
     std::vector<std::thread> threads {};
 
@@ -55,6 +80,10 @@ void runMarketDataReceiverToSequencerPipeline() {
  
     for (auto& thr : threads) 
         thr.join();
+    statsSampler.stop();
+#ifdef POOL_DEBUG
+    msgPool.dumpLive();
+#endif
     
     logger.log("runMarketDataReceiverToSequencerPipeline End\n");
 }
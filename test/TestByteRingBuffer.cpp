@@ -0,0 +1,81 @@
+// g++ -std=c++20 TestByteRingBuffer.cpp -o TestByteRingBuffer -I../include -O3
+
+#include "ByteRingBuffer.hpp"
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+
+struct TestRecord {
+    uint32_t producer;
+    uint64_t seq;
+    char text[1];   // variable length tail
+};
+
+/**************************************************************************/
+template <bool MultiProducer>
+void testByteRingBuffer(const std::string& ringType, size_t numProducers, size_t msgsPerProducer) {
+    using namespace std::chrono;
+    std::cout << "Testing " << ringType << " with " << numProducers << " producers, "
+              << msgsPerProducer << " records each...\n";
+
+    ByteRingBuffer<MultiProducer> ring(1 << 16);    // small ring, forces lots of wrap-around
+    std::vector<uint64_t> nextSeq(numProducers, 0);
+    size_t received = 0, errors = 0;
+    const size_t total = numProducers * msgsPerProducer;
+
+    auto producer = [&](uint32_t id) {
+        for (uint64_t seq = 0; seq < msgsPerProducer; ++seq) {
+            const size_t textLen = seq % 100;   // variable-length payload
+            const size_t length = offsetof(TestRecord, text) + textLen;
+            auto res = ring.reserve(length + 32);
+            while (!res.data) {
+                std::this_thread::yield();
+                res = ring.reserve(length + 32);
+            }
+            auto* rec = reinterpret_cast<TestRecord*>(res.data);
+            rec->producer = id;
+            rec->seq = seq;
+            for (size_t i = 0; i < textLen; ++i)
+                rec->text[i] = static_cast<char>('a' + (seq + i) % 26);
+            ring.commit(res, 7, length);
+        }
+    };
+
+    auto start = high_resolution_clock::now();
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < numProducers; ++p) {
+        producers.emplace_back(producer, p);
+    }
+
+    while (received < total) {
+        const size_t count = ring.consume([&](uint16_t type, const char* data, size_t length) {
+            auto* rec = reinterpret_cast<const TestRecord*>(data);
+            const size_t textLen = length - offsetof(TestRecord, text);
+            bool ok = (type == 7 && rec->producer < numProducers && rec->seq == nextSeq[rec->producer]
+                        && textLen == rec->seq % 100);
+            for (size_t i = 0; ok && i < textLen; ++i)
+                ok = (rec->text[i] == static_cast<char>('a' + (rec->seq + i) % 26));
+            if (!ok) ++errors;
+            else ++nextSeq[rec->producer];
+        });
+        if (count == 0) std::this_thread::yield();
+        received += count;
+    }
+    for (auto& thr : producers) {
+        thr.join();
+    }
+    auto end = high_resolution_clock::now();
+
+    std::cout << "\tReceived " << received << " records in "
+              << duration_cast<milliseconds>(end - start).count() << " ms, "
+              << (errors == 0 ? "all in order and intact" : "ERRORS: " + std::to_string(errors))
+              << ", ring empty: " << ring.empty() << "\n";
+}
+
+int main() {
+    testByteRingBuffer<false>("SPSCByteRingBuffer", 1, 1'000'000);
+    testByteRingBuffer<true>("MPSCByteRingBuffer", 1, 1'000'000);
+    testByteRingBuffer<true>("MPSCByteRingBuffer", 4, 250'000);
+    return 0;
+}
@@ -2,6 +2,10 @@
 
 #include "HashMap.hpp"
 
+#include <random>
+#include <thread>
+#include <atomic>
+
 /**************************************************************************/
 template <typename HM>
 void testHashMap(const std::string& hmType) {
@@ -54,9 +58,217 @@ void testHashMap(const std::string& hmType) {
     }
 }
 
+/**************************************************************************
+Random insert/erase/lookup mix checked against std::unordered_map. Keys come from a
+small range so erases hit, chains get long, and the table rehashes a few times.
+A keyStride that is a multiple of a power of two makes identity-hashed keys share
+homes, so probe runs get long regardless of the bucket count. mapArgs go to
+the map's constructor. MyIterableHM maps are also cleared now and then, and their
+size() and iteration are checked at the end.
+**************************************************************************/
+template <typename HM, typename... Args>
+void fuzzHashMap(const std::string& hmType, size_t ops, uint64_t keyRange, uint64_t keyStride = 1, 
+                 Args&&... mapArgs) {
+    std::cout << "Fuzzing " << hmType << " with " << ops << " ops over " << keyRange << " keys, stride "
+              << keyStride << "...\n";
+    HashMap<HM> hm(std::forward<Args>(mapArgs)...);
+    std::unordered_map<uint64_t, uint64_t> reference;
+    std::mt19937_64 rng(7);
+    size_t errors = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        if constexpr (MyIterableHM<HM>) {
+            if (i % 10'000 == 9'999) {
+                hm.clear();
+                reference.clear();
+            }
+        }
+        const uint64_t key = (rng() % keyRange) * keyStride;
+        switch (rng() % 4) {
+        case 0:
+            hm.insert(key, i);
+            reference[key] = i;
+            break;
+        case 1:
+            hm[key] = i;
+            reference[key] = i;
+            break;
+        case 2:
+            if (hm.erase(key) != (reference.erase(key) > 0)) ++errors;
+            break;
+        default: {
+            const uint64_t* value = hm.find(key);
+            auto it = reference.find(key);
+            if ((value == nullptr) != (it == reference.end()) || (value && *value != it->second)) ++errors;
+            if (hm.contains(key) != (it != reference.end())) ++errors;
+        }
+        }
+    }
+    for (const auto& [key, value] : reference) {
+        const uint64_t* found = hm.find(key);
+        if (found == nullptr || *found != value) ++errors;
+    }
+    if constexpr (MyIterableHM<HM>) {
+        if (hm.size() != reference.size()) ++errors;
+        size_t visited = 0;
+        for (const auto& [key, value] : hm) {
+            auto it = reference.find(key);
+            if (it == reference.end() || it->second != value) ++errors;
+            ++visited;
+        }
+        if (visited != reference.size()) ++errors;
+    }
+    std::cout << (errors == 0 ? "\tMatches std::unordered_map\n" : "\tMISMATCHES: " + std::to_string(errors) + "\n");
+}
+
+/**************************************************************************
+Grows an incrementally rehashing OpenAddressingHashMap past a few thousand slots
+so migrated pages of the old table get released, and looks up every live key
+after each insert or erase made while a rehash is under way.
+**************************************************************************/
+void testIncrementalRehash(uint64_t keys) {
+    std::cout << "Testing OpenAddressingHashMap incremental rehash with " << keys << " random keys...\n";
+    OpenAddressingHashMap<uint64_t, uint64_t> hm(1024, true);
+    std::unordered_map<uint64_t, uint64_t> reference;
+    std::vector<uint64_t> live;
+    std::mt19937_64 rng(11);
+    size_t errors = 0;
+    size_t checks = 0;
+    for (uint64_t i = 0; i < keys; ++i) {
+        if (rng() % 8 == 0 && !live.empty()) {
+            const size_t pick = rng() % live.size();
+            hm.erase(live[pick]);
+            reference.erase(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            const uint64_t key = rng();
+            hm.insert(key, i);
+            if (!reference.contains(key)) live.push_back(key);
+            reference[key] = i;
+        }
+        if (hm.rehashing()) {
+            ++checks;
+            for (const auto& [key, value] : reference) {
+                const uint64_t* found = hm.find(key);
+                if (found == nullptr || *found != value) ++errors;
+            }
+        }
+    }
+    std::cout << (errors == 0 ? "\tEvery key found at " + std::to_string(checks) + " points mid-rehash\n"
+                              : "\tMISSED: " + std::to_string(errors) + "\n");
+}
+
+/**************************************************************************
+Writers keep every symbol's state consistent (volume == 10 * trades) while readers
+check each snapshot they load, so a torn read shows up as an error. Each writer
+also churns keys of its own to exercise erase and slot reuse under contention.
+**************************************************************************/
+void testConcurrentHashMap(size_t writers, size_t readers, size_t updates) {
+    std::cout << "Testing ConcurrentHashMap with " << writers << " writers and " << readers << " readers...\n";
+    struct SymbolState {
+        uint64_t trades;
+        double volume;
+    };
+    constexpr uint64_t symbols = 64;
+    ConcurrentHashMap<uint64_t, SymbolState> hm(1024);
+    std::atomic<bool> done{ false };
+    std::atomic<size_t> errors{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            SymbolState state;
+            for (uint64_t i = r; !done.load(std::memory_order_relaxed); ++i) {
+                if (hm.load(i % symbols, state) && state.volume != 10.0 * state.trades) ++errors;
+            }
+        });
+    }
+    for (size_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            const uint64_t ownKey = 1'000'000 + w;
+            for (size_t i = 0; i < updates; ++i) {
+                hm.update(i % symbols, [](SymbolState& state) { ++state.trades; state.volume += 10.0; });
+                if (i % 64 == 0) {
+                    hm.insert(ownKey, SymbolState{ 1, 10.0 });
+                    if (!hm.contains(ownKey) || !hm.erase(ownKey) || hm.contains(ownKey)) ++errors;
+                }
+            }
+        });
+    }
+    for (size_t t = readers; t < threads.size(); ++t) threads[t].join();
+    done.store(true);
+    for (size_t t = 0; t < readers; ++t) threads[t].join();
+
+    uint64_t trades = 0;
+    for (uint64_t symbol = 0; symbol < symbols; ++symbol) {
+        SymbolState state;
+        if (hm.load(symbol, state)) trades += state.trades;
+    }
+    if (trades != writers * updates || hm.size() != symbols) ++errors;
+    std::cout << (errors == 0 ? "\tNo torn or lost updates\n" : "\tERRORS: " + std::to_string(errors.load()) + "\n");
+}
+
+/**************************************************************************
+A writer inserts fresh keys while readers poll the keys just ahead of it: a key
+must never be seen live with the value-initialized value it had before insert()
+wrote the real one.
+**************************************************************************/
+void testConcurrentHashMapPublish(size_t readers, uint64_t keys) {
+    std::cout << "Testing ConcurrentHashMap publication of new keys with " << readers << " readers...\n";
+    ConcurrentHashMap<uint64_t, uint64_t> hm(std::bit_ceil(keys * 2));
+    std::atomic<uint64_t> frontier{ 0 };
+    std::atomic<bool> done{ false };
+    std::atomic<size_t> errors{ 0 };
+    std::atomic<size_t> seen{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            uint64_t value;
+            while (!done.load(std::memory_order_relaxed)) {
+                const uint64_t key = frontier.load(std::memory_order_relaxed) + r % 2;
+                if (hm.load(key, value)) {
+                    seen.fetch_add(1, std::memory_order_relaxed);
+                    if (value != key + 1) ++errors;
+                }
+            }
+        });
+    }
+    for (uint64_t key = 0; key < keys; ++key) {
+        frontier.store(key, std::memory_order_relaxed);
+        if (key % 2 == 0) hm.insert(key, key + 1);
+        else hm.update(key, [key](uint64_t& value) { value = key + 1; });
+    }
+    done.store(true);
+    for (auto& thread : threads) thread.join();
+    std::cout << (errors == 0 ? "\tNo key seen before its value (" + std::to_string(seen.load()) + " loads hit)\n"
+                              : "\tERRORS: " + std::to_string(errors.load()) + "\n");
+}
+
 int main() {
     
     testHashMap<ChainingHashMap<int, std::string>>("ChainingHashMap<int, std::string>");
     testHashMap<FixedSizedChainingHashMap<int, std::string>>("FixedSizedChainingHashMap<int, std::string>");
     testHashMap<OpenAddressingHashMap<int, std::string>>("OpenAddressingHashMap<int, std::string>");
+    testHashMap<SwissHashMap<int, std::string>>("SwissHashMap<int, std::string>");
+    testHashMap<RobinHoodHashMap<int, std::string>>("RobinHoodHashMap<int, std::string>");
+    testHashMap<DenseHashMap<int, std::string>>("DenseHashMap<int, std::string>");
+
+    fuzzHashMap<ChainingHashMap<uint64_t, uint64_t>>("ChainingHashMap<uint64_t, uint64_t>", 200'000, 1000);
+    fuzzHashMap<FixedSizedChainingHashMap<uint64_t, uint64_t>>("FixedSizedChainingHashMap<uint64_t, uint64_t>",
+                                                               200'000, 1000);
+    fuzzHashMap<OpenAddressingHashMap<uint64_t, uint64_t>>("OpenAddressingHashMap<uint64_t, uint64_t>", 200'000, 1000);
+    fuzzHashMap<OpenAddressingHashMap<uint64_t, uint64_t>>("OpenAddressingHashMap<uint64_t, uint64_t>(16)",
+                                                           200'000, 1000, 1, 16);
+    fuzzHashMap<OpenAddressingHashMap<uint64_t, uint64_t>>("OpenAddressingHashMap<uint64_t, uint64_t>(16, incremental)",
+                                                           200'000, 1000, 1, 16, true);
+    testIncrementalRehash(50'000);
+    fuzzHashMap<SwissHashMap<uint64_t, uint64_t>>("SwissHashMap<uint64_t, uint64_t>", 200'000, 1000);
+    fuzzHashMap<RobinHoodHashMap<uint64_t, uint64_t>>("RobinHoodHashMap<uint64_t, uint64_t>", 200'000, 1000);
+    fuzzHashMap<RobinHoodHashMap<uint64_t, uint64_t>>("RobinHoodHashMap<uint64_t, uint64_t>", 200'000, 1000,
+                                                      std::max<uint64_t>(1, Const::initBuckets / 64));
+    fuzzHashMap<DenseHashMap<uint64_t, uint64_t>>("DenseHashMap<uint64_t, uint64_t>(16)", 200'000, 1000, 1, 16);
+    fuzzHashMap<STLHashMap<uint64_t, uint64_t>>("STLHashMap<uint64_t, uint64_t>", 200'000, 1000);
+    fuzzHashMap<ConcurrentHashMap<uint64_t, uint64_t>>("ConcurrentHashMap<uint64_t, uint64_t>(4096)", 200'000, 1000, 1, 4096);
+
+    testConcurrentHashMap(4, 4, 200'000);
+    testConcurrentHashMapPublish(2, 1'000'000);
 }
@@ -4,7 +4,10 @@ $ numactl --physcpubind=4 ./TestMemoryPool
 */
 
 #include "MemoryPool.hpp"
+#include "DebugPool.hpp"
+#include "Queue.hpp"
 #include <thread>
+#include <algorithm>
 
 struct alignas(64) Msg {
     double d[5];
@@ -48,13 +51,13 @@ void testMemoryPool(const std::string& poolType) {
     auto end_deallocate = high_resolution_clock::now();
 
 
-    auto duration_allocate = duration_cast<milliseconds>(end_allocate - start_allocate).count();
-    auto duration_deallocate = duration_cast<milliseconds>(end_deallocate - start_deallocate).count();
+    auto duration_allocate = duration_cast<nanoseconds>(end_allocate - start_allocate).count();
+    auto duration_deallocate = duration_cast<nanoseconds>(end_deallocate - start_deallocate).count();
     
-    std::cout << "\tAllocate Time: " << duration_allocate << " ms " << 
-        (((double)duration_allocate / Const::poolMsgCount) * 1'000'000) << " ns/op\n";
-    std::cout << "\tDeallocate Time: " << duration_deallocate << "ms " << 
-        (((double)duration_deallocate / Const::poolMsgCount) * 1'000'000)<< " ns/op\n";
+    std::cout << "\tAllocate Time: " << duration_allocate / 1e6 << " ms " << 
+        ((double)duration_allocate / Const::poolMsgCount) << " ns/op\n";
+    std::cout << "\tDeallocate Time: " << duration_deallocate / 1e6 << " ms " << 
+        ((double)duration_deallocate / Const::poolMsgCount) << " ns/op\n";
 }
 
 /**************************************************************************/
@@ -111,9 +114,10 @@ void concurrentPoolTest(const std::string& poolType, size_t numThreads, bool ver
     }
 
     auto end = std::chrono::high_resolution_clock::now();
-    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 
-    std::cout << "\tTest completed in " << elapsed_ms << " ms.\n";
+    std::cout << "\tTest completed in " << elapsed_ns / 1e6 << " ms, " 
+              << (double)elapsed_ns / (msgsPerThread * numThreads) << " ns per alloc+free.\n";
     if (verify) {
         if (!errorDetected) {
             std::cout << "\tNo data corruption detected. Pool is thread-safe under test.\n";
@@ -123,6 +127,321 @@ void concurrentPoolTest(const std::string& poolType, size_t numThreads, bool ver
     }
 }
 
+/**************************************************************************
+Drains the pool with allocate_bulk, checks every slot is handed out once, returns
+everything with deallocate_bulk and drains it again.
+**************************************************************************/
+template <typename Pool>
+void testMemoryPoolBulk(const std::string& poolType, size_t batchSize) {
+    using namespace std::chrono;
+    std::cout << "Testing bulk allocate/deallocate with " << poolType << " batch " << batchSize << "...\n";
+
+    MemoryPool<Pool> pool;
+    std::vector<Msg*> msgs(Const::poolMsgCount);
+    size_t errors = 0;
+
+    for (int round = 0; round < 2; ++round) {
+        auto start = steady_clock::now();
+        size_t allocated = 0;
+        while (allocated < msgs.size()) {
+            const size_t count = pool.allocate_bulk(std::min(batchSize, msgs.size() - allocated), &msgs[allocated]);
+            if (count == 0) break;
+            allocated += count;
+        }
+        auto mid = steady_clock::now();
+        std::vector<Msg*> sorted(msgs.begin(), msgs.begin() + allocated);
+        std::sort(sorted.begin(), sorted.end());
+        if (allocated != msgs.size() || std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            ++errors;
+        }
+        auto restart = steady_clock::now();
+        for (size_t i = 0; i < allocated; i += batchSize) {
+            pool.deallocate_bulk(std::span<Msg* const>(msgs).subspan(i, std::min(batchSize, allocated - i)));
+        }
+        auto end = steady_clock::now();
+        std::cout << "\tRound " << round << ": allocated " << allocated << ", allocate_bulk "
+                  << static_cast<double>(duration_cast<nanoseconds>(mid - start).count()) / allocated << " ns/msg, "
+                  << "deallocate_bulk " << static_cast<double>(duration_cast<nanoseconds>(end - restart).count()) / allocated
+                  << " ns/msg\n";
+    }
+    std::cout << (errors == 0 ? "\tEvery slot handed out exactly once\n" : "\tDUPLICATE OR MISSING SLOTS\n");
+}
+
+/**************************************************************************
+One thread allocates and hands messages over a queue to a second thread that
+frees them, like the receiver and the DB writer. Also times alloc/free pairs on
+a single thread. Reports ns/op for both.
+**************************************************************************/
+template <typename Pool>
+void crossThreadPoolTest(const std::string& poolType, size_t numMsgs) {
+    using namespace std::chrono;
+    std::cout << "Running cross-thread alloc/free test with " << poolType << " for " << numMsgs << " msgs...\n";
+
+    MemoryPool<Pool> pool;
+
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < numMsgs; ++i) {
+        Msg* msg = pool.allocate();
+        msg->i = i;
+        pool.deallocate(msg);
+    }
+    const double singleNs = static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+    CustomSPSCLockFreeQueue<Msg*> queue(1 << 12);
+    size_t errors = 0;
+    std::thread consumer([&]() {
+        for (size_t i = 0; i < numMsgs; ++i) {
+            Msg* msg = nullptr;
+            while ((msg = queue.dequeue()) == nullptr) std::this_thread::yield();
+            if (msg->i != i) ++errors;
+            pool.deallocate(msg);
+        }
+    });
+    start = steady_clock::now();
+    for (size_t i = 0; i < numMsgs; ++i) {
+        Msg* msg = nullptr;
+        while ((msg = pool.allocate()) == nullptr) std::this_thread::yield(); // rest is parked in magazines
+        msg->i = i;
+        while (!queue.enqueue(msg)) std::this_thread::yield();
+    }
+    consumer.join();
+    const double crossNs = static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+    std::cout << "\tSingle thread alloc+free: " << singleNs / numMsgs << " ns/op, "
+              << "cross-thread alloc->free: " << crossNs / numMsgs << " ns/msg, "
+              << (errors == 0 ? "no corruption" : "CORRUPTION: " + std::to_string(errors)) << "\n";
+}
+
+/**************************************************************************
+Every thread runs opsPerThread random allocate/free (single and bulk) operations
+against a shared pool, holding up to 64 messages at a time. Each message carries
+an in-use flag flipped with an atomic exchange and the owner's id, so a slot handed
+out twice or freed while owned by another thread is counted as an error.
+**************************************************************************/
+template <typename Pool>
+void stressPoolTest(const std::string& poolType, size_t numThreads, size_t opsPerThread) {
+    using namespace std::chrono;
+    std::cout << "Running stress test with " << poolType << ", " << numThreads << " threads x " 
+              << opsPerThread << " ops...\n";
+
+    MemoryPool<Pool> pool;
+    std::atomic<size_t> errors{ 0 };
+    std::atomic<size_t> exhausted{ 0 };
+
+    auto acquire = [&](Msg* msg, size_t threadId) {
+        if (std::atomic_ref<char>(msg->c).exchange(1, std::memory_order_acq_rel) != 0) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        msg->i = threadId;
+    };
+    auto release = [&](Msg* msg, size_t threadId) {
+        if (msg->i != threadId || std::atomic_ref<char>(msg->c).exchange(0, std::memory_order_acq_rel) != 1) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    auto worker = [&](size_t threadId) {
+        constexpr size_t maxHeld = 64;
+        constexpr size_t batch = 8;
+        std::vector<Msg*> held;
+        held.reserve(maxHeld);
+        uint64_t rng = 0x9E3779B97F4A7C15ull * (threadId + 1);
+        for (size_t op = 0; op < opsPerThread; ++op) {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+            const bool doAllocate = held.empty() || (held.size() < maxHeld && (rng & 1));
+            const bool bulk = (rng & 0x30) == 0;
+            if (doAllocate) {
+                Msg* msgs[batch];
+                const size_t count = bulk ? pool.allocate_bulk(std::min(batch, maxHeld - held.size()), msgs)
+                                          : ((msgs[0] = pool.allocate()) != nullptr);
+                if (count == 0) exhausted.fetch_add(1, std::memory_order_relaxed);
+                for (size_t i = 0; i < count; ++i) {
+                    acquire(msgs[i], threadId);
+                    held.push_back(msgs[i]);
+                }
+            }
+            else if (bulk) {
+                const size_t count = std::min(batch, held.size());
+                const std::span<Msg* const> msgs(held.data() + held.size() - count, count);
+                for (Msg* msg : msgs) release(msg, threadId);
+                pool.deallocate_bulk(msgs);
+                held.resize(held.size() - count);
+            }
+            else {
+                release(held.back(), threadId);
+                pool.deallocate(held.back());
+                held.pop_back();
+            }
+        }
+        for (Msg* msg : held) release(msg, threadId);
+        pool.deallocate_bulk(held);
+    };
+
+    auto start = steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    for (auto& thr : threads) {
+        thr.join();
+    }
+    const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    std::cout << "\tCompleted in " << elapsed << " ms, empty pool seen " << exhausted.load() << " times, "
+              << (errors == 0 ? "no slot handed out twice" : "ERRORS: " + std::to_string(errors.load())) << "\n";
+}
+
+/**************************************************************************
+Builds the pool with the given page placement and times the first pass over every
+slot, which is where page faults and TLB misses show up. Also checks the runtime
+slot count is honoured: the pool hands out exactly count slots.
+**************************************************************************/
+/**************************************************************************
+A small buffer asked for huge pages maps only what it needs when it falls back
+to normal pages: one 4K page for 64 Msgs, not a whole 2MB huge page.
+**************************************************************************/
+void testBufferFootprint() {
+    std::cout << "Testing HugePageBuffer footprint...\n";
+    HugePageBuffer<Msg> buffer(64, PageOptions{ PageSize::Huge2M, -1, true });
+    const size_t expected = buffer.hugePages() ? static_cast<size_t>(PageSize::Huge2M)
+                                               : static_cast<size_t>(PageSize::Default4K);
+    std::cout << "\t" << (buffer.hugePages() ? "huge pages" : "normal pages") << ", page size " << buffer.pageSize()
+              << (buffer.pageSize() == expected ? " as obtained\n" : " WRONG\n");
+}
+
+/**************************************************************************
+release() only hands back whole pages of the buffer's own page size and reports
+where it stopped, so a caller releasing as it drains never skips a page.
+**************************************************************************/
+void testBufferRelease() {
+    std::cout << "Testing HugePageBuffer release...\n";
+    HugePageBuffer<uint64_t> buffer(1 << 20, PageOptions{ PageSize::Huge2M, -1, true });
+    const size_t perPage = buffer.pageSize() / sizeof(uint64_t);
+    std::fill(buffer.data(), buffer.data() + buffer.size(), 1);
+    size_t errors = 0;
+    if (buffer.release(0, perPage - 1) != 0) ++errors;                   // less than a page
+    if (buffer.release(0, perPage + 1) != perPage || buffer[0] != 0 || buffer[perPage] != 1) ++errors;
+    if (buffer.release(perPage, buffer.size()) != buffer.size() || buffer[buffer.size() - 1] != 0) ++errors;
+    std::cout << (errors == 0 ? "\tReleased whole " + std::to_string(buffer.pageSize()) + "B pages\n"
+                              : "\tERRORS: " + std::to_string(errors) + "\n");
+}
+
+template <typename Pool>
+void testPoolPlacement(const std::string& poolType, size_t count, PageOptions options) {
+    using namespace std::chrono;
+    std::cout << "Testing placement with " << poolType << " count " << count << " page " 
+              << static_cast<size_t>(options.pageSize) << " node " << options.numaNode 
+              << (options.prefault ? " prefaulted" : " lazy") << "...\n";
+
+    auto start = steady_clock::now();
+    MemoryPool<Pool> pool(count, options);
+    const auto built = steady_clock::now();
+
+    std::vector<Msg*> msgs;
+    msgs.reserve(count);
+    while (Msg* msg = pool.allocate()) {
+        msg->i = msgs.size();
+        msgs.push_back(msg);
+    }
+    const auto touched = steady_clock::now();
+    for (Msg* msg : msgs) {
+        pool.deallocate(msg);
+    }
+    std::cout << "\tConstruct: " << duration_cast<microseconds>(built - start).count() << " us, first touch: "
+              << static_cast<double>(duration_cast<nanoseconds>(touched - built).count()) / count << " ns/msg, "
+              << (msgs.size() == count ? "all slots" : "WRONG SLOT COUNT: " + std::to_string(msgs.size())) << "\n";
+}
+
+/**************************************************************************
+Starts a SegmentedPool with one slab and allocates several slabs' worth, tagging
+every message, so the pool has to grow through its spare slabs and, once those run
+out faster than they are replaced, on the allocating thread. Verifies the tags
+afterwards (addresses stay stable while slabs are added), that every pointer is
+unique, and that a second pass after freeing everything does not grow again.
+**************************************************************************/
+template <size_t SlabSize>
+void testSegmentedPoolGrowth(size_t numSlabs) {
+    using namespace std::chrono;
+    const size_t numMsgs = numSlabs * SlabSize;
+    std::cout << "Testing SegmentedPool growth from 1 slab to " << numSlabs << " slabs of " << SlabSize << "...\n";
+
+    SegmentedPool<Msg, SlabSize> pool(1, 2);
+    std::vector<Msg*> msgs(numMsgs);
+    size_t errors = 0;
+
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < numMsgs; ++i) {
+        msgs[i] = pool.allocate();
+        if (msgs[i] == nullptr) {
+            std::cout << "\tSegmentedPool returned nullptr at " << i << "\n";
+            return;
+        }
+        msgs[i]->i = i;
+    }
+    const double allocNs = static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    for (size_t i = 0; i < numMsgs; ++i) {
+        if (msgs[i]->i != i) ++errors;
+    }
+    std::vector<Msg*> sorted(msgs);
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) ++errors;
+
+    const size_t slabsAfterGrowth = pool.slabs();
+    pool.deallocate_bulk(std::span<Msg* const>(msgs).first(numMsgs / 2));
+    for (size_t i = numMsgs / 2; i < numMsgs; ++i) {
+        pool.deallocate(msgs[i]);
+    }
+    for (size_t i = 0; i < numMsgs; ++i) {
+        msgs[i] = pool.allocate();
+    }
+    if (pool.slabs() != slabsAfterGrowth) ++errors;
+
+    std::cout << "\tAllocate incl. growth: " << allocNs / numMsgs << " ns/op, slabs: " << pool.slabs() 
+              << ", grown on the allocating thread: " << pool.coldGrowths() << ", "
+              << (errors == 0 ? "addresses stable and unique" : "ERRORS: " + std::to_string(errors)) << "\n";
+}
+
+/**************************************************************************
+Walks a DebugPool through a small pipeline: tags messages with stages, checks a
+double free and a foreign pointer throw, and dumps the slots left live.
+**************************************************************************/
+template <typename Pool>
+void testDebugPool(const std::string& poolType) {
+    std::cout << "Testing DebugPool<" << poolType << ">...\n";
+    DebugPool<Pool> pool;
+    size_t errors = 0;
+
+    std::vector<Msg*> msgs(10);
+    for (Msg*& msg : msgs) {
+        msg = pool.allocate();
+        trackOwner(pool, msg, "Receiver");
+    }
+    for (size_t i = 0; i < 6; ++i) {
+        trackOwner(pool, msgs[i], "Writer");
+    }
+    pool.deallocate_bulk(std::span<Msg* const>(msgs).first(4));     // writer frees 4, leaks 2
+
+    auto expectThrow = [&](const char* what, auto&& fn) {
+        try {
+            fn();
+            std::cout << "\t" << what << " NOT detected\n";
+            ++errors;
+        }
+        catch (const std::runtime_error& e) {
+            std::cout << "\t" << what << " detected: " << e.what() << "\n";
+        }
+    };
+    expectThrow("Double free", [&] { pool.deallocate(msgs[0]); });
+    Msg foreign;
+    expectThrow("Foreign pointer", [&] { pool.deallocate(&foreign); });
+    expectThrow("Use after free", [&] { trackOwner(pool, msgs[1], "Writer"); });
+
+    if (pool.liveCount() != 6) ++errors;
+    pool.dumpLive(std::cout);
+    std::cout << (errors == 0 ? "\tDebugPool checks passed\n" : "\tDEBUGPOOL ERRORS\n");
+
+    pool.deallocate_bulk(std::span<Msg* const>(msgs).subspan(4));
+}
+
 int main() {
     
     testMemoryPool<BoostPool<Msg, false>>("BoostPool<Msg, false>");
@@ -131,9 +450,37 @@ int main() {
 
     concurrentPoolTest<BoostPool<Msg, true>>("BoostPool<Msg, true>", 10, true);
     concurrentPoolTest<LockFreeThreadSafePool<Msg, true>>("LockFreeThreadSafePool<Msg, true>", 10, true);
+    concurrentPoolTest<LockFreeThreadSafePool<Msg, true, 64>>("LockFreeThreadSafePool<Msg, true, 64>", 10, true);
+    concurrentPoolTest<CustomLockFreePool<Msg, true>>("CustomLockFreePool<Msg, true>", 10, true);
+
+    testMemoryPoolBulk<CustomLockedPool<Msg, true>>("CustomLockedPool<Msg, true>", 1000);
+    testMemoryPoolBulk<CustomLockFreePool<Msg, true>>("CustomLockFreePool<Msg, true>", 1000);
+    testMemoryPoolBulk<LockFreeThreadSafePool<Msg, true>>("LockFreeThreadSafePool<Msg, true>", 1000);
+    testMemoryPoolBulk<LockFreeThreadSafePool<Msg, true, 64>>("LockFreeThreadSafePool<Msg, true, 64>", 1000);
+
+    crossThreadPoolTest<LockFreeThreadSafePool<Msg, true>>("LockFreeThreadSafePool<Msg, true>", 1'000'000);
+    crossThreadPoolTest<LockFreeThreadSafePool<Msg, true, 64>>("LockFreeThreadSafePool<Msg, true, 64>", 1'000'000);
+
+    testBufferFootprint();
+    testBufferRelease();
+    testPoolPlacement<LockFreeThreadSafePool<Msg, true>>("LockFreeThreadSafePool<Msg, true>", 
+        Const::poolMsgCount / 2, PageOptions{ PageSize::Default4K, -1, false });
+    testPoolPlacement<LockFreeThreadSafePool<Msg, true>>("LockFreeThreadSafePool<Msg, true>", 
+        Const::poolMsgCount / 2, PageOptions{ PageSize::Huge2M, numaNodeOfCpu(0), true });
+
+    testSegmentedPoolGrowth<1 << 12>(32);
+    concurrentPoolTest<SegmentedPool<Msg, 1 << 12>>("SegmentedPool<Msg, 4096>", 10, true);
+
+    testDebugPool<LockFreeThreadSafePool<Msg, true>>("LockFreeThreadSafePool<Msg, true>");
+    testDebugPool<BoostPool<Msg, true>>("BoostPool<Msg, true>");
+    stressPoolTest<DebugPool<LockFreeThreadSafePool<Msg, true>>>("DebugPool<LockFreeThreadSafePool<Msg, true>>",
+                                                                 8, 200'000);
+
+    stressPoolTest<CustomLockFreePool<Msg, true>>("CustomLockFreePool<Msg, true>", 16, 1'000'000);
+    stressPoolTest<LockFreeThreadSafePool<Msg, true>>("LockFreeThreadSafePool<Msg, true>", 16, 1'000'000);
+    stressPoolTest<SegmentedPool<Msg, 1 << 12>>("SegmentedPool<Msg, 4096>", 16, 1'000'000);
     
     // concurrentPoolTest<CustomLockedPool<Msg, false>>("CustomLockedPool<Msg, true>", 10, true);
-    // concurrentPoolTest<CustomLockFreePool<Msg, true>>("CustomLockFreePool<Msg, true>", 10, true);
     // concurrentPoolTest<FollyIndexedMemPool<Msg, true>>("FollyIndexedMemPool<Msg, true>", 10, true);
 
     return 0;
@@ -161,4 +508,8 @@ Running concurrent test with 10 threads, 10000 messages per thread with BoostPoo
 Running concurrent test with 10 threads, 10000 messages per thread with LockFreeThreadSafePool<Msg, true>using count: 100000...
 	Test completed in 32 ms.
 	No data corruption detected. Pool is thread-safe under test.
+Running cross-thread alloc/free test with LockFreeThreadSafePool<Msg, true> for 1000000 msgs...
+	Single thread alloc+free: 30.1465 ns/op, cross-thread alloc->free: 32.7017 ns/msg, no corruption
+Running cross-thread alloc/free test with LockFreeThreadSafePool<Msg, true, 64> for 1000000 msgs...
+	Single thread alloc+free: 8.93384 ns/op, cross-thread alloc->free: 17.4903 ns/msg, no corruption
 */
\ No newline at end of file
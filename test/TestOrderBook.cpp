@@ -4,13 +4,21 @@ $ numactl --physcpubind=4 ./TestOrderBook
 */
 
 #include "OrderBook.hpp"
+#include "BenchUtils.hpp"
 
-void benchmark_orderbook() {
+#include <cmath>
+#include <map>
+#include <memory>
+#include <set>
+
+template <template <typename, typename> class OrderMap>
+void benchmark_orderbook(const std::string& mapType) {
     using namespace std::chrono;
 
-    std::cout << "Benchmarking OrderBook with " << Const::NumOrders << " orders\n";
+    std::cout << "Benchmarking OrderBook with " << Const::NumOrders << " orders using " << mapType << "\n";
 
-    OrderBook<false> book;
+    auto bookPtr = std::make_unique<OrderBook<false, OrderMap>>();
+    auto& book = *bookPtr;
     std::vector<Order> orders;
     orders.reserve(Const::NumOrders);
 
@@ -58,18 +66,14 @@ void benchmark_orderbook() {
 
     book.print(std::cout, "Cancel", 5);
 
-    auto duration_insert = duration_cast<milliseconds>(end_insert - start_insert).count();
-    auto duration_update = duration_cast<milliseconds>(end_update - start_update).count();
-    auto duration_cancel = duration_cast<milliseconds>(end_cancel - start_cancel).count();
-
-    std::cout << "Insert Time: " << duration_insert << " ms → "
-              << (Const::NumOrders * 1000.0 / duration_insert) << " ops/sec\n";
-
-    std::cout << "Update Time: " << duration_update << " ms → "
-              << (Const::NumOrders * 1000.0 / duration_update) << " ops/sec\n";
-
-    std::cout << "Cancel Time: " << duration_cancel << " ms → "
-              << (Const::NumOrders * 1000.0 / duration_cancel) << " ops/sec\n";
+    auto report = [](const char* what, nanoseconds elapsed) {
+        const double ns = static_cast<double>(elapsed.count());
+        std::cout << "    " << what << " Time: " << ns / 1e6 << " ms → " << (Const::NumOrders * 1e9 / ns) 
+                  << " ops/sec | " << ns / Const::NumOrders << " ns/op\n";
+    };
+    report("Insert", end_insert - start_insert);
+    report("Update", end_update - start_update);
+    report("Cancel", end_cancel - start_cancel);
 
     auto best_bid = book.bestBid();
     auto best_ask = book.bestAsk();
@@ -80,6 +84,210 @@ void benchmark_orderbook() {
     std::cout << "Top-of-book empty after all cancels.\n";
 }
 
+/**************************************************************************
+Per-operation latency with Const::NumOrders orders live. Every step cancels the
+oldest order, inserts a new one and updates a random live order, so the book
+stays at full size while ids keep advancing the way exchange order ids do.
+Percentiles are in ns with the rdtsc overhead removed.
+**************************************************************************/
+template <template <typename, typename> class OrderMap>
+void latency_orderbook(const std::string& mapType, size_t steps) {
+    std::cout << "Latency of OrderBook with " << Const::NumOrders << " live orders using " << mapType << "\n";
+
+    auto bookPtr = std::make_unique<OrderBook<false, OrderMap>>();
+    auto& book = *bookPtr;
+    std::vector<Order> orders(Const::NumOrders + steps);
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> price_dist(99.5, 100.5);
+    std::uniform_int_distribution<int> qty_dist(1, 100);
+    for (uint64_t i = 0; i < orders.size(); ++i) {
+        orders[i] = Order{i, price_dist(rng), qty_dist(rng), (rng() & 1) != 0};
+    }
+    for (size_t i = 0; i < Const::NumOrders; ++i) {
+        book.insert(&orders[i]);
+    }
+
+    bench::timerOverhead();         // measure before timing
+    bench::TscClock::nsPerTick();   // calibrate before timing
+
+    bench::LatencyHistogram insertLatency, updateLatency, cancelLatency;
+    for (size_t i = 0; i < steps; ++i) {
+        uint64_t start = bench::rdtsc();
+        book.cancel(i);
+        bench::recordTicks(cancelLatency, start, bench::rdtsc());
+
+        start = bench::rdtsc();
+        book.insert(&orders[Const::NumOrders + i]);
+        bench::recordTicks(insertLatency, start, bench::rdtsc());
+
+        const uint64_t id = i + 1 + rng() % Const::NumOrders;
+        const int quantity = qty_dist(rng);
+        start = bench::rdtsc();
+        book.update(id, quantity);
+        bench::recordTicks(updateLatency, start, bench::rdtsc());
+    }
+
+    auto report = [](const char* what, const bench::LatencyHistogram& histogram) {
+        auto ns = [&](double p) { return bench::TscClock::toNs(histogram.percentile(p)); };
+        std::cout << "    " << what << " p50: " << ns(50) << " ns | p99: " << ns(99) << " ns | p99.9: " 
+                  << ns(99.9) << " ns | max: " << bench::TscClock::toNs(histogram.max()) << " ns\n";
+    };
+    report("Insert", insertLatency);
+    report("Update", updateLatency);
+    report("Cancel", cancelLatency);
+}
+
+// Random set/clear on a LevelBitmap, next() and prev() checked against std::set
+void testLevelBitmap(size_t ops) {
+    std::cout << "Testing LevelBitmap with " << ops << " ops...\n";
+    constexpr size_t Levels = 100'000;      // three bitmap levels
+    auto bitmap = std::make_unique<LevelBitmap<Levels>>();
+    std::set<size_t> reference;
+    std::mt19937_64 rng(7);
+    size_t errors = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        // Few occupied levels at first, so searches cross words and groups
+        const size_t level = (i % 2 == 0) ? rng() % Levels : (rng() % 64) * (Levels / 64);
+        if (rng() % 3 == 0) {
+            bitmap->clear(level);
+            reference.erase(level);
+        }
+        else if (i > ops / 2 || rng() % 8 == 0) {
+            bitmap->set(level);
+            reference.insert(level);
+        }
+        const size_t probe = rng() % Levels;
+        auto above = reference.lower_bound(probe);
+        auto below = reference.upper_bound(probe);
+        const int next = (above == reference.end()) ? -1 : static_cast<int>(*above);
+        const int prev = (below == reference.begin()) ? -1 : static_cast<int>(*std::prev(below));
+        if (bitmap->next(probe) != next || bitmap->prev(probe) != prev) ++errors;
+    }
+    std::cout << (errors == 0 ? "\tMatches std::set\n" : "\tMISMATCHES: " + std::to_string(errors) + "\n");
+}
+
+/**************************************************************************
+Inserts, updates and cancels around a mid that random-walks over thousands of
+dollars from 100,000.00, far beyond the ladder window, with a few orders far
+from mid. Best bid and ask are checked after every op against std::map books.
+**************************************************************************/
+void testPriceLadder(size_t ops) {
+    std::cout << "Testing OrderBook price ladder with " << ops << " ops...\n";
+    auto bookPtr = std::make_unique<OrderBook<true>>(1 << 16, 1 << 16);
+    auto& book = *bookPtr;
+    std::map<int64_t, int> bids, asks;
+    std::vector<Order> live;
+    std::mt19937_64 rng(7);
+    int64_t mid = 10'000'000;
+    uint64_t nextId = 0;
+    size_t errors = 0;
+    auto adjust = [&](const Order& order, int quantity) {
+        auto& side = order.is_buy ? bids : asks;
+        const int64_t ticks = std::llround(order.price * Const::TicksPerUnit);
+        if ((side[ticks] += quantity) == 0) side.erase(ticks);
+    };
+    for (size_t i = 0; i < ops; ++i) {
+        mid += static_cast<int64_t>(rng() % 21) - 10;
+        const uint64_t r = rng() % 10;
+        if (r < 4 || live.empty()) {
+            const bool isBuy = (rng() & 1) != 0;
+            int64_t offset = 1 + static_cast<int64_t>(rng() % 500);
+            if (rng() % 50 == 0) offset *= 200;     // far from mid, beyond the window
+            const double price = (isBuy ? mid - offset : mid + offset) * Const::TickSize;
+            live.push_back(Order{ nextId++, price, 1 + static_cast<int>(rng() % 100), isBuy });
+            book.insert(&live.back());
+            adjust(live.back(), live.back().quantity);
+        }
+        else {
+            const size_t slot = rng() % live.size();
+            Order& order = live[slot];
+            if (r < 6) {
+                const int quantity = 1 + static_cast<int>(rng() % 100);
+                book.update(order.order_id, quantity);
+                adjust(order, quantity - order.quantity);
+                order.quantity = quantity;
+            }
+            else {
+                book.cancel(order.order_id);
+                adjust(order, -order.quantity);
+                order = live.back();
+                live.pop_back();
+            }
+        }
+        const std::pair<double, int> bid = bids.empty() ? std::pair<double, int>{ 0.0, 0 } 
+            : std::pair<double, int>{ bids.rbegin()->first * Const::TickSize, bids.rbegin()->second };
+        const std::pair<double, int> ask = asks.empty() ? std::pair<double, int>{ 0.0, 0 } 
+            : std::pair<double, int>{ asks.begin()->first * Const::TickSize, asks.begin()->second };
+        if (book.bestBid() != bid || book.bestAsk() != ask) ++errors;
+    }
+    book.print(std::cout, "Ladder at " + std::to_string(mid * Const::TickSize), 5);
+    for (const auto& order : live) {
+        book.cancel(order.order_id);
+    }
+    if (book.bestBid() != std::pair<double, int>{ 0.0, 0 } || book.bestAsk() != std::pair<double, int>{ 0.0, 0 }) ++errors;
+    std::cout << (errors == 0 ? "\tMatches std::map books\n" : "\tMISMATCHES: " + std::to_string(errors) + "\n");
+}
+
+/**************************************************************************
+Cancel latency on a sparse book: levels occupied price levels per side, scattered
+over the ladder window around a BTC-like mid of 100,000.00, one order each.
+Every step cancels the best bid and the best ask, so the book has to find the
+next occupied level however far away it is, then re-inserts both at new random
+levels on their side of mid.
+**************************************************************************/
+void sparse_orderbook(size_t levels, size_t steps) {
+    std::cout << "Cancel latency of a sparse OrderBook with " << levels << " levels per side\n";
+    auto bookPtr = std::make_unique<OrderBook<false>>();
+    auto& book = *bookPtr;
+    std::mt19937_64 rng(42);
+    constexpr int64_t midTicks = 10'000'000;
+    constexpr int64_t halfWindow = Const::LadderLevels / 2;
+    auto randomPrice = [&rng](bool isBuy) {
+        const int64_t offset = 1 + static_cast<int64_t>(rng() % (halfWindow - 1));
+        return (isBuy ? midTicks - offset : midTicks + offset) * Const::TickSize;
+    };
+    std::vector<Order> orders(2 * (levels + steps));
+    uint64_t nextId = 0;
+    auto add = [&](bool isBuy) {
+        Order& order = orders[nextId];
+        order = Order{ nextId++, randomPrice(isBuy), 1, isBuy };
+        book.insert(&order);
+    };
+    for (size_t i = 0; i < levels; ++i) {
+        add(true);
+        add(false);
+    }
+
+    bench::timerOverhead();         // measure before timing
+    bench::TscClock::nsPerTick();   // calibrate before timing
+
+    // The best level holds one order (or a few on a repeated price); cancel them all
+    std::vector<std::vector<uint64_t>> idsAtPrice(2);
+    bench::LatencyHistogram cancelLatency;
+    for (size_t step = 0; step < steps; ++step) {
+        for (bool isBuy : { true, false }) {
+            const double best = isBuy ? book.bestBid().first : book.bestAsk().first;
+            const long bestLevel = std::lround(best * Const::TicksPerUnit);
+            auto& ids = idsAtPrice[isBuy];
+            ids.clear();
+            for (uint64_t id = 0; id < nextId; ++id) {
+                const long level = std::lround(orders[id].price * Const::TicksPerUnit);
+                if (orders[id].is_buy == isBuy && orders[id].quantity > 0 && level == bestLevel) ids.push_back(id);
+            }
+            for (uint64_t id : ids) {
+                const uint64_t start = bench::rdtsc();
+                book.cancel(id);
+                bench::recordTicks(cancelLatency, start, bench::rdtsc());
+                orders[id].quantity = 0;
+            }
+            add(isBuy);
+        }
+    }
+    auto ns = [&](double p) { return bench::TscClock::toNs(cancelLatency.percentile(p)); };
+    std::cout << "    Cancel p50: " << ns(50) << " ns | p99: " << ns(99) << " ns | max: " 
+              << bench::TscClock::toNs(cancelLatency.max()) << " ns\n";
+}
+
 int main() {
     
     {
@@ -104,9 +312,29 @@ int main() {
         }
     }
 
+    testLevelBitmap(1'000'000);
+    testPriceLadder(1'000'000);
+
     {
         std::cout << "Running OrderBook benchmark...\n";
-        benchmark_orderbook();
+        benchmark_orderbook<ChainingHashMap>("ChainingHashMap");
+        benchmark_orderbook<FixedSizedChainingHashMap>("FixedSizedChainingHashMap");
+        benchmark_orderbook<OpenAddressingHashMap>("OpenAddressingHashMap");
+        benchmark_orderbook<STLHashMap>("STLHashMap");
+        benchmark_orderbook<SwissHashMap>("SwissHashMap");
+        benchmark_orderbook<RobinHoodHashMap>("RobinHoodHashMap");
+    }
+
+    {
+        std::cout << "Running OrderBook latency benchmark...\n";
+        latency_orderbook<FixedSizedChainingHashMap>("FixedSizedChainingHashMap", Const::NumOrders);
+        latency_orderbook<RobinHoodHashMap>("RobinHoodHashMap", Const::NumOrders);
+    }
+
+    {
+        std::cout << "Running sparse OrderBook benchmark...\n";
+        sparse_orderbook(16, 2'000);
+        sparse_orderbook(1'000, 2'000);
     }
 
     return 0;
@@ -0,0 +1,157 @@
+/*
+$ g++ -std=c++20 -O3 -o TestOrderBookManager TestOrderBookManager.cpp -I../include -I.
+$ ./TestOrderBookManager
+*/
+
+#include "OrderBookManager.hpp"
+#include "BenchUtils.hpp"
+
+#include <random>
+
+struct Command {
+    BookCommandType type;
+    SymbolId symbol;
+    Order order;
+};
+
+/**************************************************************************
+Command stream over symbols: half inserts, a quarter updates and a quarter
+cancels of live orders, prices around a per-symbol level so books differ.
+**************************************************************************/
+std::vector<Command> makeCommands(size_t symbols, size_t count) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> priceDist(-0.5, 0.5);
+    std::uniform_int_distribution<int> qtyDist(1, 100);
+    std::vector<std::vector<uint64_t>> live(symbols);
+    std::vector<Command> commands;
+    commands.reserve(count);
+    uint64_t nextId = 0;
+    while (commands.size() < count) {
+        const SymbolId symbol = static_cast<SymbolId>(rng() % symbols);
+        auto& orders = live[symbol];
+        const uint64_t r = rng() % 4;
+        if (r < 2 || orders.empty()) {
+            const double price = 100.0 + static_cast<double>(symbol % 500) + priceDist(rng);
+            commands.push_back({ BookCommandType::Insert, symbol, Order{ nextId, price, qtyDist(rng), (rng() & 1) != 0 } });
+            orders.push_back(nextId++);
+        }
+        else {
+            const size_t slot = rng() % orders.size();
+            const uint64_t id = orders[slot];
+            if (r == 2) {
+                commands.push_back({ BookCommandType::Update, symbol, Order{ id, 0.0, qtyDist(rng), false } });
+            }
+            else {
+                commands.push_back({ BookCommandType::Cancel, symbol, Order{ id, 0.0, 0, false } });
+                orders[slot] = orders.back();
+                orders.pop_back();
+            }
+        }
+    }
+    return commands;
+}
+
+template <typename Manager>
+void feed(Manager& manager, const std::vector<Command>& commands) {
+    for (const auto& command : commands) {
+        bool sent = false;
+        while (!sent) {
+            switch (command.type) {
+            case BookCommandType::Insert: sent = manager.insert(command.symbol, command.order); break;
+            case BookCommandType::Update: sent = manager.update(command.symbol, command.order.order_id,
+                                                                command.order.quantity); break;
+            case BookCommandType::Cancel: sent = manager.cancel(command.symbol, command.order.order_id); break;
+            }
+            if (!sent) bench::cpuRelax();
+        }
+    }
+}
+
+/**************************************************************************
+Every shard's books must end up where single-threaded OrderBooks fed the same
+commands end up, and a reader polling top of book meanwhile must never see a
+quantity paired with a price from an earlier state of the slot.
+**************************************************************************/
+void testOrderBookManager(size_t shards, size_t symbols, size_t count) {
+    std::cout << "Testing OrderBookManager with " << shards << " shards and " << symbols << " symbols...\n";
+    const std::vector<Command> commands = makeCommands(symbols, count);
+    OrderBookManager<> manager(shards, symbols);
+    std::atomic<bool> done{ false };
+    std::atomic<size_t> errors{ 0 };
+    std::thread reader([&] {
+        for (SymbolId symbol = 0; !done.load(std::memory_order_relaxed); symbol = (symbol + 1) % symbols) {
+            const TopOfBook top = manager.topOfBook(symbol);
+            // An emptied side may keep a price, but a quantity never comes without its price
+            if (top.bidQuantity < 0 || top.askQuantity < 0 || (top.bidQuantity > 0 && top.bidPrice < 99.0) ||
+                (top.askQuantity > 0 && top.askPrice < 99.0)) ++errors;
+        }
+    });
+    manager.start();
+    feed(manager, commands);
+    manager.stop();
+    done.store(true);
+    reader.join();
+
+    std::vector<std::unique_ptr<OrderBook<true>>> reference;
+    for (size_t s = 0; s < symbols; ++s) {
+        reference.emplace_back(std::make_unique<OrderBook<true>>(Const::bookOrderBuckets, Const::bookMaxOrders));
+    }
+    for (const auto& command : commands) {
+        auto& book = *reference[command.symbol];
+        Order order = command.order;
+        switch (command.type) {
+        case BookCommandType::Insert: book.insert(&order); break;
+        case BookCommandType::Update: book.update(order.order_id, order.quantity); break;
+        case BookCommandType::Cancel: book.cancel(order.order_id); break;
+        }
+    }
+    for (SymbolId symbol = 0; symbol < symbols; ++symbol) {
+        const TopOfBook top = manager.topOfBook(symbol);
+        const auto [bidPrice, bidQuantity] = reference[symbol]->bestBid();
+        const auto [askPrice, askQuantity] = reference[symbol]->bestAsk();
+        if (!(top == TopOfBook{ bidPrice, bidQuantity, askPrice, askQuantity })) ++errors;
+    }
+    if (manager.processed() != commands.size() || manager.rejected() != 0) ++errors;
+    try {
+        manager.topOfBook(static_cast<SymbolId>(symbols));
+        ++errors;
+    }
+    catch (const std::runtime_error&) { }   // unknown ids are refused, not read out of bounds
+    std::cout << (errors == 0 ? "\tMatches single-threaded books\n" : "\tERRORS: " + std::to_string(errors.load()) + "\n");
+}
+
+/**************************************************************************
+Commands per second from the first enqueue until every shard has applied its
+last command, for 1, 2, 4 ... maxShards workers pinned from cpu 1 on while
+the feed thread stays on cpu 0.
+**************************************************************************/
+void benchmarkScaling(size_t maxShards, size_t symbols, size_t count) {
+    std::cout << "Benchmarking OrderBookManager with " << symbols << " symbols and " << count << " commands\n";
+    const std::vector<Command> commands = makeCommands(symbols, count);
+    bench::pinThread(0);
+    for (size_t shards = 1; shards <= maxShards; shards *= 2) {
+        OrderBookManager<> manager(shards, symbols);
+        manager.start(1);
+        for (SymbolId symbol = 0; symbol < symbols; ++symbol) {  // create the books before timing
+            manager.cancel(symbol, UINT64_MAX);
+        }
+        while (manager.processed() < symbols) bench::cpuRelax();
+
+        const auto start = std::chrono::steady_clock::now();
+        feed(manager, commands);
+        while (manager.processed() < symbols + commands.size()) bench::cpuRelax();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        manager.stop();
+        std::cout << "    " << shards << " shards: " << commands.size() / seconds / 1e6 << " M commands/s\n";
+    }
+}
+
+int main() {
+    testOrderBookManager(1, 8, 200'000);
+    testOrderBookManager(4, 64, 400'000);
+
+    const size_t maxShards = std::max<size_t>(1, std::thread::hardware_concurrency() - 1);
+    benchmarkScaling(std::min<size_t>(maxShards, 16), 256, 4'000'000);
+
+    return 0;
+}
@@ -1,12 +1,22 @@
 // g++ -std=c++20 TestQueue.cpp -o TestQueue -I../include -O3 -DQUEUE_CAPACITY=2048
 
 #include "Queue.hpp"
+#include "WaitStrategy.hpp"
+#include <thread>
+#include <ctime>
+
+// Bounded queues at the default capacity, LockedQueue is unbounded and takes none
+template <typename Q>
+Q makeQueue() {
+    if constexpr (std::constructible_from<Q, size_t>) return Q(Const::queueCapacity);
+    else return Q();
+}
 
 template <typename Q>
 void testQueue(const std::string& queueType) {
     std::cout << "Testing with " << queueType << "...\n";
     
-    Queue<Q> queue;
+    auto queue = makeQueue<Queue<Q>>();
     double* msg1 = new double(5.0);
     double* msg2 = new double(6.0);
     queue.enqueue(msg1);
@@ -26,13 +36,215 @@ void testQueue(const std::string& queueType) {
     delete received1, received2;
 }
 
+template <typename Q>
+void testQueueBulk(const std::string& queueType) {
+    std::cout << "Testing bulk enqueue/dequeue with " << queueType << "...\n";
+
+    auto queue = makeQueue<Queue<Q>>();
+    std::vector<double> values(100);
+    std::vector<double*> in(values.size()), out(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<double>(i);
+        in[i] = &values[i];
+    }
+    const size_t enqueued = queue.enqueue_bulk(in);
+    size_t dequeued = 0;
+    while (dequeued < enqueued) {
+        const size_t count = queue.dequeue_bulk(std::span<double*>(out).subspan(dequeued, 7));
+        if (count == 0) break;
+        dequeued += count;
+    }
+    bool ordered = (enqueued == values.size() && dequeued == enqueued);
+    for (size_t i = 0; ordered && i < dequeued; ++i) {
+        ordered = (out[i] == in[i]);
+    }
+    std::cout << "Enqueued: " << enqueued << " Dequeued: " << dequeued 
+              << (ordered ? " in order" : " OUT OF ORDER") << std::endl;
+}
+
+template <typename Q, typename Wait>
+void testQueueWait(const std::string& queueType) {
+    std::cout << "Testing idle consumer with " << queueType << "...\n";
+
+    Q queue;
+    constexpr size_t numMsgs = 20;
+    std::vector<double> values(numMsgs);
+    size_t received = 0;
+    double consumerCpuMs = 0.0;
+
+    std::thread consumer([&]() {
+        Wait wait;
+        while (received < numMsgs) {
+            if (queue.dequeue()) {
+                ++received;
+                wait.reset();
+            }
+            else {
+                wait.idle(queue);
+            }
+        }
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        consumerCpuMs = ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+    });
+
+    for (size_t i = 0; i < numMsgs; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // idle market
+        queue.enqueue(&values[i]);
+    }
+    consumer.join();
+    std::cout << "Received: " << received << "/" << numMsgs << " consumer cpu time: " 
+              << consumerCpuMs << " ms over ~" << numMsgs * 10 << " ms wall\n";
+}
+
+template <typename Q>
+void testQueueStats(const std::string& queueType) {
+    std::cout << "Testing stats on a full queue with " << queueType << "...\n";
+
+    auto queue = makeQueue<Q>();
+    const size_t attempts = Const::queueCapacity + 16; // LockedQueue is unbounded and never rejects
+    std::vector<double> values(attempts);
+    std::atomic<bool> runFlag{ true };
+    size_t accepted = 0;
+    for (size_t i = 0; i < attempts; ++i) {
+        accepted += enqueueWithBackpressure(queue, &values[i], Backpressure::CountAndDrop, runFlag, [](double*) { });
+    }
+    for (size_t i = 0; i < 10; ++i) {
+        queue.dequeue();
+    }
+    const QueueStats stats = queue.stats();
+    const bool ok = (stats.enqueued == accepted && stats.rejected == attempts - accepted 
+                     && stats.dequeued == 10 && stats.highWater == accepted && stats.size() == accepted - 10);
+    std::cout << "Enqueued: " << stats.enqueued << " Rejected: " << stats.rejected 
+              << " Dequeued: " << stats.dequeued << " HighWater: " << stats.highWater 
+              << " Size: " << stats.size() << (ok ? " consistent" : " INCONSISTENT") << std::endl;
+}
+
+/**************************************************************************
+Producers and consumers racing on one queue: occupancy must stay within the
+capacity, and a producer blocked on a full queue must not count as rejected.
+**************************************************************************/
+template <typename Q>
+void testQueueStatsContended(const std::string& queueType, size_t threads) {
+    std::cout << "Testing stats under contention with " << queueType << "...\n";
+
+    Q queue(64);
+    const size_t perProducer = 200'000;
+    std::vector<double> values(perProducer * threads);
+    std::atomic<bool> runFlag{ true };
+    std::atomic<size_t> received{ 0 };
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = 0; i < perProducer; ++i) {
+                enqueueWithBackpressure(queue, &values[t * perProducer + i], Backpressure::Block, runFlag,
+                                        [](double*) { });
+            }
+        });
+        workers.emplace_back([&] {
+            while (received.load(std::memory_order_relaxed) < values.size()) {
+                if (queue.dequeue() != nullptr) received.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const QueueStats stats = queue.stats();
+    const bool ok = (stats.enqueued == values.size() && stats.dequeued == values.size() && stats.rejected == 0
+                     && stats.highWater > 0 && stats.highWater <= 64);
+    std::cout << "Enqueued: " << stats.enqueued << " Rejected: " << stats.rejected
+              << " HighWater: " << stats.highWater << (ok ? " consistent" : " INCONSISTENT") << std::endl;
+}
+
+template <typename Q>
+void testQueueCapacity(const std::string& queueType, size_t capacity) {
+    std::cout << "Testing per-instance capacity " << capacity << " with " << queueType << "...\n";
+
+    Queue<Q> queue(capacity);
+    std::vector<double> values(capacity * 2);
+    size_t accepted = 0;
+    while (accepted < values.size() && queue.enqueue(&values[accepted])) {
+        ++accepted;
+    }
+    std::cout << "Accepted: " << accepted << (accepted == capacity ? " as sized" : " WRONG SIZE") << std::endl;
+}
+
+template <typename Q>
+void testBackpressure(const std::string& queueType, Backpressure policy) {
+    std::cout << "Testing backpressure with " << queueType << "...\n";
+
+    Q queue;
+    std::atomic<bool> runFlag{ true };
+    std::vector<double> values(Const::queueCapacity + 10);
+    size_t dropped = 0;
+    double* firstDropped = nullptr;
+    auto drop = [&](double* msg) {
+        if (dropped++ == 0) firstDropped = msg;
+    };
+    size_t delivered = 0;
+    for (auto& value : values) {
+        delivered += enqueueWithBackpressure(queue, &value, policy, runFlag, drop);
+    }
+    double* head = queue.dequeue();
+    std::cout << "Delivered: " << delivered << " Dropped: " << dropped 
+              << " First dropped: #" << (firstDropped ? firstDropped - values.data() : -1)
+              << " Head: #" << (head ? head - values.data() : -1) << std::endl;
+}
+
 int main() {
     
     testQueue<LockedQueue<double*>>("LockedQueue");
     testQueue<CustomSPSCLockFreeQueue<double*>>("CustomSPSCLockFreeQueue");
+    testQueue<CustomCachedSPSCLockFreeQueue<double*>>("CustomCachedSPSCLockFreeQueue");
     testQueue<CustomMPMCLockFreeQueue<double*>>("CustomMPMCLockFreeQueue");
     testQueue<BoostLockFreeQueue<double*>>("BoostLockFreeQueue");
 #ifdef USE_MOODYCAMEL_QUEUE
     testQueue<MoodycamelLockFreeQueue<double*>>("MoodycamelLockFreeQueue");
 #endif
+
+    testQueueBulk<LockedQueue<double*>>("LockedQueue");
+    testQueueBulk<CustomSPSCLockFreeQueue<double*>>("CustomSPSCLockFreeQueue");
+    testQueueBulk<CustomCachedSPSCLockFreeQueue<double*>>("CustomCachedSPSCLockFreeQueue");
+    testQueueBulk<CustomMPMCLockFreeQueue<double*>>("CustomMPMCLockFreeQueue");
+    testQueueBulk<BoostLockFreeQueue<double*>>("BoostLockFreeQueue");
+#ifdef USE_MOODYCAMEL_QUEUE
+    testQueueBulk<MoodycamelLockFreeQueue<double*>>("MoodycamelLockFreeQueue");
+#endif
+
+    testQueueWait<CustomSPSCLockFreeQueue<double*>, YieldWait>("CustomSPSCLockFreeQueue + YieldWait");
+    testQueueWait<WaitableQueue<CustomSPSCLockFreeQueue<double*>>, AdaptiveWait>(
+        "WaitableQueue<CustomSPSCLockFreeQueue> + AdaptiveWait");
+    testQueueWait<WaitableQueue<CustomMPMCLockFreeQueue<double*>>, AdaptiveWait>(
+        "WaitableQueue<CustomMPMCLockFreeQueue> + AdaptiveWait");
+
+    testQueueStats<LockedQueue<double*>>("LockedQueue");
+    testQueueStats<CustomSPSCLockFreeQueue<double*>>("CustomSPSCLockFreeQueue");
+    testQueueStats<CustomCachedSPSCLockFreeQueue<double*>>("CustomCachedSPSCLockFreeQueue");
+    testQueueStats<CustomMPMCLockFreeQueue<double*>>("CustomMPMCLockFreeQueue");
+    testQueueStats<BoostLockFreeQueue<double*>>("BoostLockFreeQueue");
+#ifdef USE_MOODYCAMEL_QUEUE
+    testQueueStats<MoodycamelLockFreeQueue<double*>>("MoodycamelLockFreeQueue");
+#endif
+
+    testQueueStatsContended<CustomSPSCLockFreeQueue<double*>>("CustomSPSCLockFreeQueue", 1);
+    testQueueStatsContended<CustomMPMCLockFreeQueue<double*>>("CustomMPMCLockFreeQueue", 4);
+
+    testQueueCapacity<CustomSPSCLockFreeQueue<double*>>("CustomSPSCLockFreeQueue", 64);
+    testQueueCapacity<CustomCachedSPSCLockFreeQueue<double*>>("CustomCachedSPSCLockFreeQueue", 64);
+    testQueueCapacity<CustomMPMCLockFreeQueue<double*>>("CustomMPMCLockFreeQueue", 64);
+    testQueueCapacity<BoostLockFreeQueue<double*>>("BoostLockFreeQueue", 64);
+    testQueueCapacity<WaitableQueue<CustomSPSCLockFreeQueue<double*>>>("WaitableQueue<CustomSPSCLockFreeQueue>", 1 << 16);
+
+    testBackpressure<CustomSPSCLockFreeQueue<double*>>("CustomSPSCLockFreeQueue + CountAndDrop", 
+        Backpressure::CountAndDrop);
+    testBackpressure<CustomMPMCLockFreeQueue<double*>>("CustomMPMCLockFreeQueue + DropOldest", 
+        Backpressure::DropOldest);
+    try {
+        checkBackpressure<CustomSPSCLockFreeQueue<double*>>(Backpressure::DropOldest);
+        std::cout << "DropOldest on an SPSC queue was NOT rejected\n";
+    }
+    catch (const std::invalid_argument& ex) {
+        std::cout << "DropOldest on an SPSC queue rejected: " << ex.what() << "\n";
+    }
 }
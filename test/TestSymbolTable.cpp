@@ -0,0 +1,69 @@
+// g++ -std=c++20 TestSymbolTable.cpp -o TestSymbolTable -O3 -I../include -I.
+
+#include "SymbolTable.hpp"
+#include "Messages.hpp"
+#include "BenchUtils.hpp"
+
+#include <random>
+
+/**************************************************************************/
+void setSymbol(ITCHTradeMsg& msg, const std::string& symbol) {
+    std::memset(msg.symbol, 0, sizeof(msg.symbol));
+    std::memcpy(msg.symbol, symbol.data(), std::min(symbol.size(), sizeof(msg.symbol)));
+}
+
+void testSymbolTable() {
+    std::cout << "Testing SymbolTable...\n";
+    const std::vector<std::string> symbols = { "ETHUSDC", "ETHUSDT", "BTCUSDT", "BTCFDUSD", "SOLBTC", "X" };
+    SymbolTable table(2);   // smaller than the symbol count, so the table grows
+    size_t errors = 0;
+    ITCHTradeMsg msg{};
+    for (size_t round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            setSymbol(msg, symbols[i]);
+            if (table.intern(msg.symbol) != i || table.find(msg.symbol) != i) ++errors;
+            if (table.name(static_cast<SymbolId>(i)) != symbols[i]) ++errors;   // BTCFDUSD fills all 8 bytes
+        }
+    }
+    setSymbol(msg, "DOGEUSDT");
+    if (table.find(msg.symbol) != SymbolTable::InvalidId || table.size() != symbols.size()) ++errors;
+    std::cout << (errors == 0 ? "\tIds and names match\n" : "\tERRORS: " + std::to_string(errors) + "\n");
+}
+
+/**************************************************************************
+Per-trade cost of the aggregator's lookup: building a std::string from the symbol
+field and hashing it, against interning the field and indexing by id.
+**************************************************************************/
+void timeSymbolLookup(size_t symbolCount, size_t trades) {
+    std::vector<ITCHTradeMsg> msgs(trades);
+    std::mt19937_64 rng(42);
+    for (auto& msg : msgs) {
+        setSymbol(msg, "SYM" + std::to_string(rng() % symbolCount));
+    }
+    HashMap<DenseHashMap<std::string, double>> byName(std::bit_ceil(symbolCount * 2));
+    HashMap<DenseHashMap<SymbolId, double>> byId(std::bit_ceil(symbolCount * 2));
+    SymbolTable table;
+
+    uint64_t start = bench::rdtsc();
+    for (const auto& msg : msgs) {
+        byName[std::string(msg.symbol, strnlen(msg.symbol, sizeof(msg.symbol)))] += msg.price;
+    }
+    const double nameNs = bench::TscClock::toNs(bench::rdtsc() - start) / trades;
+
+    start = bench::rdtsc();
+    for (const auto& msg : msgs) {
+        byId[table.intern(msg.symbol)] += msg.price;
+    }
+    const double idNs = bench::TscClock::toNs(bench::rdtsc() - start) / trades;
+
+    std::cout << "\t" << symbolCount << " symbols: std::string key " << nameNs << " ns/trade, interned id "
+              << idNs << " ns/trade" << (byName.size() == byId.size() ? "" : " (MISMATCH)") << "\n";
+}
+
+int main() {
+    testSymbolTable();
+
+    std::cout << "Timing symbol lookups...\n";
+    timeSymbolLookup(16, 1'000'000);
+    timeSymbolLookup(1000, 1'000'000);
+}